@@ -0,0 +1,101 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class BitPlane {
+public:
+    using Word = uint64_t;
+
+    static constexpr size_t kWordBits = 64;
+
+    BitPlane() = default;
+
+    BitPlane(size_t width, size_t height, bool value = false) {
+        Assign(width, height, value);
+    }
+
+    void Assign(size_t width, size_t height, bool value = false) {
+        width_ = width;
+        height_ = height;
+        words_per_row_ = (width + kWordBits - 1) / kWordBits;
+        words_.assign(words_per_row_ * height, value ? ~Word{0} : Word{0});
+        if (value && width % kWordBits) {
+            const Word tail = (Word{1} << (width % kWordBits)) - 1;
+            for (size_t y = 0; y < height; ++y) {
+                Row(y)[words_per_row_ - 1] = tail;
+            }
+        }
+    }
+
+    void Clear() noexcept {
+        width_ = 0;
+        height_ = 0;
+        words_per_row_ = 0;
+        words_.clear();
+    }
+
+    bool Test(size_t x, size_t y) const noexcept {
+        return (Row(y)[x / kWordBits] >> (x % kWordBits)) & 1;
+    }
+
+    void Set(size_t x, size_t y) noexcept {
+        Row(y)[x / kWordBits] |= Word{1} << (x % kWordBits);
+    }
+
+    void Reset(size_t x, size_t y) noexcept {
+        Row(y)[x / kWordBits] &= ~(Word{1} << (x % kWordBits));
+    }
+
+    void Flip(size_t x, size_t y) noexcept {
+        Row(y)[x / kWordBits] ^= Word{1} << (x % kWordBits);
+    }
+
+    Word *Row(size_t y) noexcept {
+        return words_.data() + y * words_per_row_;
+    }
+
+    const Word *Row(size_t y) const noexcept {
+        return words_.data() + y * words_per_row_;
+    }
+
+    size_t Width() const noexcept {
+        return width_;
+    }
+
+    size_t Height() const noexcept {
+        return height_;
+    }
+
+    size_t WordsPerRow() const noexcept {
+        return words_per_row_;
+    }
+
+    Word *Data() noexcept {
+        return words_.data();
+    }
+
+    const Word *Data() const noexcept {
+        return words_.data();
+    }
+
+    size_t WordsCount() const noexcept {
+        return words_.size();
+    }
+
+    size_t Count() const noexcept {
+        size_t result = 0;
+        for (const Word word: words_) {
+            result += static_cast<size_t>(std::popcount(word));
+        }
+        return result;
+    }
+
+private:
+    size_t width_{0};
+    size_t height_{0};
+    size_t words_per_row_{0};
+    std::vector<Word> words_;
+};
@@ -0,0 +1,141 @@
+#include "BoardGenerator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t kStreamChunkBytes = size_t{4} << 20;
+
+void GenerateRange(const BoardGenerator::BoardParams &params, std::span<const uint64_t> seeds, std::byte *out) {
+    const size_t board_size = BoardGenerator::BoardSize(params);
+    BitPlane mines;
+    std::vector<uint8_t> scratch;
+    Xoshiro256 gen;
+    for (const uint64_t seed: seeds) {
+        gen.Seed(seed);
+        BoardGenerator::PlaceMines(mines, params.width, params.height, params.mines_count, gen);
+        const size_t plane_bytes = mines.WordsCount() * sizeof(BitPlane::Word);
+        std::memcpy(out, mines.Data(), plane_bytes);
+        uint8_t *near = reinterpret_cast<uint8_t *>(out + plane_bytes);
+        BoardGenerator::CountMinesNear(mines, near, params.width, scratch);
+        const size_t used = plane_bytes + params.width * params.height;
+        std::memset(out + used, 0, board_size - used);
+        out += board_size;
+    }
+}
+
+}  // namespace
+
+size_t BoardGenerator::BoardSize(const BoardParams &params) noexcept {
+    const size_t words_per_row = (params.width + BitPlane::kWordBits - 1) / BitPlane::kWordBits;
+    const size_t plane_bytes = words_per_row * params.height * sizeof(BitPlane::Word);
+    return (plane_bytes + params.width * params.height + 7) / 8 * 8;
+}
+
+void BoardGenerator::GenerateBoards(const BoardParams &params, std::span<const uint64_t> seeds,
+                                    std::span<std::byte> out, size_t threads_count) {
+    if (params.mines_count > params.height * params.width) {
+        throw std::runtime_error("Too many mines");
+    }
+    const size_t board_size = BoardSize(params);
+    if (out.size() < seeds.size() * board_size) {
+        throw std::runtime_error("Board buffer is too small");
+    }
+    const size_t workers_count = std::clamp<size_t>(threads_count, 1, std::max<size_t>(seeds.size(), 1));
+    const size_t per_worker = (seeds.size() + workers_count - 1) / workers_count;
+    std::vector<std::jthread> workers;
+    workers.reserve(workers_count - 1);
+    for (size_t begin = per_worker; begin < seeds.size(); begin += per_worker) {
+        const auto range = seeds.subspan(begin, std::min(per_worker, seeds.size() - begin));
+        workers.emplace_back(GenerateRange, params, range, out.data() + begin * board_size);
+    }
+    GenerateRange(params, seeds.first(std::min(per_worker, seeds.size())), out.data());
+}
+
+void BoardGenerator::GenerateBoards(const BoardParams &params, std::span<const uint64_t> seeds, std::ostream &out,
+                                    size_t threads_count) {
+    const size_t board_size = BoardSize(params);
+    const size_t chunk_boards = std::max<size_t>(kStreamChunkBytes / std::max<size_t>(board_size, 1), 1);
+    std::vector<std::byte> buffer(std::min(chunk_boards, seeds.size()) * board_size);
+    for (size_t begin = 0; begin < seeds.size(); begin += chunk_boards) {
+        const auto chunk = seeds.subspan(begin, std::min(chunk_boards, seeds.size() - begin));
+        GenerateBoards(params, chunk, buffer, threads_count);
+        out.write(reinterpret_cast<const char *>(buffer.data()),
+                  static_cast<std::streamsize>(chunk.size() * board_size));
+        if (!out) {
+            throw std::runtime_error("Failed to write boards");
+        }
+    }
+}
+
+void BoardGenerator::PlaceMines(BitPlane &mines, size_t width, size_t height, size_t mines_count, Xoshiro256 &gen,
+                                std::span<const size_t> excluded) {
+    // Floyd's sampling picks k distinct cells in k draws, using the mine plane
+    // itself as the set of picked cells. Dense boards pick the free cells
+    // instead, so the work is min(k, W * H - k) draws either way. Excluded
+    // cells (sorted linear indices) are skipped over when mapping a draw to
+    // a cell.
+    const size_t cells_count = height * width - excluded.size();
+    const bool dense = mines_count > cells_count / 2;
+    const size_t picks = dense ? cells_count - mines_count : mines_count;
+    mines.Assign(width, height, dense);
+    for (const size_t index: excluded) {
+        mines.Reset(index % width, index / width);
+    }
+    auto to_cell_index = [excluded](size_t index) {
+        for (const size_t skipped: excluded) {
+            index += skipped <= index;
+        }
+        return index;
+    };
+    for (size_t j = cells_count - picks; j < cells_count; ++j) {
+        size_t index = to_cell_index(gen.Below(j + 1));
+        if (mines.Test(index % width, index / width) != dense) {
+            index = to_cell_index(j);
+        }
+        if (dense) {
+            mines.Reset(index % width, index / width);
+        } else {
+            mines.Set(index % width, index / width);
+        }
+    }
+}
+
+void BoardGenerator::CountMinesNear(const BitPlane &mines, uint8_t *out, size_t out_stride,
+                                    std::vector<uint8_t> &scratch) {
+    // Separable 3x3 box sum: horizontal sums per row, then three rows added.
+    const size_t width = mines.Width();
+    const size_t height = mines.Height();
+    scratch.assign(width + 2 + 3 * width, 0);
+    uint8_t *bits = scratch.data();
+    auto horizontal_sum = [&](size_t y, uint8_t *sum) {
+        const BitPlane::Word *row = mines.Row(y);
+        for (size_t x = 0; x < width; ++x) {
+            bits[x + 1] = static_cast<uint8_t>((row[x / BitPlane::kWordBits] >> (x % BitPlane::kWordBits)) & 1);
+        }
+        for (size_t x = 0; x < width; ++x) {
+            sum[x] = static_cast<uint8_t>(bits[x] + bits[x + 1] + bits[x + 2]);
+        }
+    };
+    uint8_t *prev = bits + width + 2;
+    uint8_t *cur = prev + width;
+    uint8_t *next = cur + width;
+    if (height) {
+        horizontal_sum(0, cur);
+    }
+    for (size_t y = 0; y < height; ++y) {
+        if (y + 1 < height) {
+            horizontal_sum(y + 1, next);
+        } else {
+            std::fill(next, next + width, 0);
+        }
+        uint8_t *row_out = out + y * out_stride;
+        for (size_t x = 0; x < width; ++x) {
+            row_out[x] = static_cast<uint8_t>(prev[x] + cur[x] + next[x]);
+        }
+        std::swap(prev, cur);
+        std::swap(cur, next);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "BitPlane.h"
+#include "Xoshiro256.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <thread>
+#include <vector>
+
+// Bulk generation of seeded boards without constructing games. Each board
+// is written as one record of BoardSize() bytes:
+//   mine plane   Height() rows of WordsPerRow() 64-bit words, native order,
+//                the same padded layout as BitPlane
+//   adjacency    width * height bytes, mines in the 3x3 block around each
+//                cell (the cell itself included), row-major
+//   padding      zero bytes up to a multiple of 8
+// A seed produces the same layout as Minesweeper(width, height, mines, seed).
+class BoardGenerator {
+public:
+    struct BoardParams {
+        size_t width = 0;
+        size_t height = 0;
+        size_t mines_count = 0;
+    };
+
+    static size_t BoardSize(const BoardParams &params) noexcept;
+
+    static void GenerateBoards(const BoardParams &params, std::span<const uint64_t> seeds, std::span<std::byte> out,
+                               size_t threads_count = std::thread::hardware_concurrency());
+
+    static void GenerateBoards(const BoardParams &params, std::span<const uint64_t> seeds, std::ostream &out,
+                               size_t threads_count = std::thread::hardware_concurrency());
+
+    static void PlaceMines(BitPlane &mines, size_t width, size_t height, size_t mines_count, Xoshiro256 &gen,
+                           std::span<const size_t> excluded = {});
+
+    static void CountMinesNear(const BitPlane &mines, uint8_t *out, size_t out_stride, std::vector<uint8_t> &scratch);
+};
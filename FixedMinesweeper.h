@@ -0,0 +1,307 @@
+#pragma once
+
+#include "Minesweeper.h"
+#include "Xoshiro256.h"
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+template <size_t W, size_t H>
+class FixedMinesweeper {
+public:
+    static_assert(W > 0 && H > 0 && W * H <= UINT16_MAX, "Unsupported fixed board size");
+
+    using Cell = Minesweeper::Cell;
+
+    using GameStatus = Minesweeper::GameStatus;
+
+    using RenderedField = Minesweeper::RenderedField;
+
+    using Clock = Minesweeper::Clock;
+
+    static constexpr size_t kWidth = W;
+    static constexpr size_t kHeight = H;
+    static constexpr size_t kCells = W * H;
+
+    FixedMinesweeper(size_t mines_count, uint64_t seed) {
+        NewGame(mines_count, seed);
+    }
+
+    explicit FixedMinesweeper(const std::vector<Cell> &cells_with_mines) {
+        NewGame(cells_with_mines);
+    }
+
+    void NewGame(size_t mines_count, uint64_t seed) {
+        if (mines_count > kCells) {
+            throw std::runtime_error("Too many mines");
+        }
+        ResetValues();
+        seed_ = seed;
+        FillMines(mines_count);
+    }
+
+    void NewGame(const std::vector<Cell> &cells_with_mines) {
+        if (cells_with_mines.size() > kCells) {
+            throw std::runtime_error("Too many mines");
+        }
+        for (const auto &cell: cells_with_mines) {
+            if (!IsCorrectBoundary(cell)) {
+                throw std::runtime_error("Incorrect mine position");
+            }
+        }
+        ResetValues();
+        for (const auto &cell: cells_with_mines) {
+            const size_t index = ToIndex(cell);
+            if (!Test(mines_, index)) {
+                Set(mines_, index);
+                ++mines_count_;
+            }
+        }
+    }
+
+    void OpenCell(const Cell &cell) {
+        if (!IsCorrectBoundary(cell)) {
+            throw std::runtime_error("A cell outside the field boundary");
+        }
+        const size_t index = ToIndex(cell);
+        if (IsFinishedGame() || Test(marked_, index) || !Test(closed_, index)) {
+            return;
+        }
+        if (status_ == GameStatus::NOT_STARTED) {
+            StartGame();
+        }
+        if (Test(mines_, index)) {
+            Defeat();
+            return;
+        }
+        std::array<uint16_t, kCells> stack;
+        size_t stack_size = 0;
+        stack[stack_size++] = static_cast<uint16_t>(index);
+        OpenClosed(index);
+        while (stack_size) {
+            const size_t cur_index = stack[--stack_size];
+            if (CalcMinesNear(cur_index)) {
+                continue;
+            }
+            const size_t x = cur_index % W;
+            const size_t y = cur_index / W;
+            for (size_t ny = (y ? y - 1 : 0); ny <= y + 1 && ny < H; ++ny) {
+                for (size_t nx = (x ? x - 1 : 0); nx <= x + 1 && nx < W; ++nx) {
+                    const size_t neighbor_index = ny * W + nx;
+                    if (Test(closed_, neighbor_index) && !Test(marked_, neighbor_index)) {
+                        stack[stack_size++] = static_cast<uint16_t>(neighbor_index);
+                        OpenClosed(neighbor_index);
+                    }
+                }
+            }
+        }
+        VictoryCheck();
+    }
+
+    void MarkCell(const Cell &cell) {
+        if (!IsCorrectBoundary(cell)) {
+            throw std::runtime_error("A cell outside the field boundary");
+        }
+        const size_t index = ToIndex(cell);
+        if (IsFinishedGame() || !Test(closed_, index)) {
+            return;
+        }
+        if (status_ == GameStatus::NOT_STARTED) {
+            StartGame();
+        }
+        if (Test(marked_, index)) {
+            --marked_count_;
+        } else {
+            ++marked_count_;
+        }
+        marked_[index / 64] ^= uint64_t{1} << (index % 64);
+    }
+
+    GameStatus GetGameStatus() const noexcept {
+        return status_;
+    }
+
+    uint64_t GetSeed() const noexcept {
+        return seed_;
+    }
+
+    time_t GetGameTime() const noexcept {
+        return static_cast<time_t>(std::chrono::duration_cast<std::chrono::seconds>(GetGameDuration()).count());
+    }
+
+    Clock::duration GetGameDuration() const noexcept {
+        if (status_ == GameStatus::NOT_STARTED) {
+            return {};
+        }
+        if (status_ == GameStatus::IN_PROGRESS) {
+            return Clock::now() - start_time_;
+        }
+        return finish_time_ - start_time_;
+    }
+
+    RenderedField RenderField() const {
+        RenderedField result(H);
+        for (size_t y = 0; y < H; ++y) {
+            result[y].resize(W);
+            RenderRow(y, result[y].data());
+        }
+        return result;
+    }
+
+    void RenderField(std::span<char> buffer, size_t stride) const {
+        if (stride < W) {
+            throw std::runtime_error("Row stride is less than the field width");
+        }
+        if (buffer.size() < (H - 1) * stride + W) {
+            throw std::runtime_error("Render buffer is too small");
+        }
+        for (size_t y = 0; y < H; ++y) {
+            RenderRow(y, buffer.data() + y * stride);
+        }
+    }
+
+private:
+    using Plane = std::array<uint64_t, (kCells + 63) / 64>;
+
+    Plane mines_{};
+    Plane marked_{};
+    Plane closed_{};
+    uint64_t seed_{0};
+    Clock::time_point start_time_{};
+    Clock::time_point finish_time_{};
+    uint16_t mines_count_{0};
+    uint16_t marked_count_{0};
+    uint16_t closed_count_{0};
+    GameStatus status_{GameStatus::NOT_STARTED};
+
+    static bool Test(const Plane &plane, size_t index) noexcept {
+        return (plane[index / 64] >> (index % 64)) & 1;
+    }
+
+    static void Set(Plane &plane, size_t index) noexcept {
+        plane[index / 64] |= uint64_t{1} << (index % 64);
+    }
+
+    static void Reset(Plane &plane, size_t index) noexcept {
+        plane[index / 64] &= ~(uint64_t{1} << (index % 64));
+    }
+
+    static size_t ToIndex(const Cell &cell) noexcept {
+        return cell.y * W + cell.x;
+    }
+
+    static bool IsCorrectBoundary(const Cell &cell) noexcept {
+        return cell.x < W && cell.y < H;
+    }
+
+    void ResetValues() noexcept {
+        mines_ = {};
+        marked_ = {};
+        closed_ = {};
+        for (size_t index = 0; index < kCells; ++index) {
+            Set(closed_, index);
+        }
+        seed_ = 0;
+        start_time_ = {};
+        finish_time_ = {};
+        mines_count_ = 0;
+        marked_count_ = 0;
+        closed_count_ = kCells;
+        status_ = GameStatus::NOT_STARTED;
+    }
+
+    void FillMines(size_t mines_count) noexcept {
+        // Same Floyd sampling as Minesweeper::FillMines, so a seed deals the
+        // same layout on both classes.
+        Xoshiro256 gen(seed_);
+        const bool dense = mines_count > kCells / 2;
+        const size_t picks = dense ? kCells - mines_count : mines_count;
+        if (dense) {
+            for (size_t index = 0; index < kCells; ++index) {
+                Set(mines_, index);
+            }
+        }
+        for (size_t j = kCells - picks; j < kCells; ++j) {
+            size_t index = gen.Below(j + 1);
+            if (Test(mines_, index) != dense) {
+                index = j;
+            }
+            if (dense) {
+                Reset(mines_, index);
+            } else {
+                Set(mines_, index);
+            }
+        }
+        mines_count_ = static_cast<uint16_t>(mines_count);
+    }
+
+    void StartGame() noexcept {
+        status_ = GameStatus::IN_PROGRESS;
+        start_time_ = Clock::now();
+    }
+
+    void Defeat() noexcept {
+        status_ = GameStatus::DEFEAT;
+        finish_time_ = Clock::now();
+    }
+
+    void VictoryCheck() noexcept {
+        if (closed_count_ != mines_count_) {
+            return;
+        }
+        status_ = GameStatus::VICTORY;
+        finish_time_ = Clock::now();
+    }
+
+    void OpenClosed(size_t index) noexcept {
+        Reset(closed_, index);
+        --closed_count_;
+    }
+
+    bool IsFinishedGame() const noexcept {
+        return (status_ == GameStatus::VICTORY || status_ == GameStatus::DEFEAT);
+    }
+
+    size_t CalcMinesNear(size_t index) const noexcept {
+        const size_t x = index % W;
+        const size_t y = index / W;
+        size_t result = 0;
+        for (size_t ny = (y ? y - 1 : 0); ny <= y + 1 && ny < H; ++ny) {
+            for (size_t nx = (x ? x - 1 : 0); nx <= x + 1 && nx < W; ++nx) {
+                result += Test(mines_, ny * W + nx);
+            }
+        }
+        return result;
+    }
+
+    void RenderRow(size_t y, char *out) const noexcept {
+        for (size_t x = 0; x < W; ++x) {
+            const size_t index = y * W + x;
+            if (Test(mines_, index) && status_ == GameStatus::DEFEAT) {
+                out[x] = '*';
+            } else if (Test(marked_, index)) {
+                out[x] = '?';
+            } else if (Test(closed_, index)) {
+                out[x] = '-';
+            } else {
+                const size_t mines = CalcMinesNear(index);
+                out[x] = mines ? static_cast<char>('0' + mines) : '.';
+            }
+        }
+    }
+};
+
+using BeginnerMinesweeper = FixedMinesweeper<9, 9>;
+
+using IntermediateMinesweeper = FixedMinesweeper<16, 16>;
+
+using ExpertMinesweeper = FixedMinesweeper<30, 16>;
+
+static_assert(std::is_trivially_copyable_v<ExpertMinesweeper>);
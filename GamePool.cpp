@@ -0,0 +1,113 @@
+#include "GamePool.h"
+
+#include <algorithm>
+#include <bit>
+
+GamePool::Lease::Lease(GamePool *pool, std::unique_ptr<Minesweeper> game) noexcept
+        : pool_(pool), game_(std::move(game)) {
+}
+
+GamePool::Lease::Lease(Lease &&other) noexcept : pool_(other.pool_), game_(std::move(other.game_)) {
+    other.pool_ = nullptr;
+}
+
+GamePool::Lease &GamePool::Lease::operator=(Lease &&other) noexcept {
+    if (this != &other) {
+        Release();
+        pool_ = other.pool_;
+        game_ = std::move(other.game_);
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+GamePool::Lease::~Lease() {
+    Release();
+}
+
+void GamePool::Lease::Release() noexcept {
+    if (pool_ && game_) {
+        pool_->Recycle(std::move(game_));
+    }
+    pool_ = nullptr;
+    game_.reset();
+}
+
+Minesweeper *GamePool::Lease::Get() const noexcept {
+    return game_.get();
+}
+
+Minesweeper &GamePool::Lease::operator*() const noexcept {
+    return *game_;
+}
+
+Minesweeper *GamePool::Lease::operator->() const noexcept {
+    return game_.get();
+}
+
+GamePool::Lease::operator bool() const noexcept {
+    return game_ != nullptr;
+}
+
+GamePool::GamePool(size_t max_idle_per_class) : max_idle_per_class_(max_idle_per_class) {
+}
+
+GamePool::Lease GamePool::Acquire(size_t width, size_t height, size_t mines_count) {
+    auto game = TakeIdle(width, height);
+    if (game) {
+        game->NewGame(width, height, mines_count);
+    } else {
+        game = std::make_unique<Minesweeper>(width, height, mines_count);
+    }
+    return Lease(this, std::move(game));
+}
+
+GamePool::Lease GamePool::Acquire(size_t width, size_t height, size_t mines_count, uint64_t seed,
+                                  Minesweeper::MinePlacement placement) {
+    auto game = TakeIdle(width, height);
+    if (game) {
+        game->NewGame(width, height, mines_count, seed, placement);
+    } else {
+        game = std::make_unique<Minesweeper>(width, height, mines_count, seed, placement);
+    }
+    return Lease(this, std::move(game));
+}
+
+size_t GamePool::IdleCount() const noexcept {
+    size_t result = 0;
+    for (const auto &games: idle_) {
+        result += games.size();
+    }
+    return result;
+}
+
+size_t GamePool::GetSizeClass(size_t width, size_t height) noexcept {
+    return static_cast<size_t>(std::bit_width(width * height));
+}
+
+std::unique_ptr<Minesweeper> GamePool::TakeIdle(size_t width, size_t height) {
+    const size_t size_class = GetSizeClass(width, height);
+    if (size_class >= idle_.size()) {
+        idle_.resize(size_class + 1);
+    }
+    if (idle_[size_class].empty()) {
+        idle_[size_class].reserve(max_idle_per_class_);
+        return nullptr;
+    }
+    auto game = std::move(idle_[size_class].back());
+    idle_[size_class].pop_back();
+    return game;
+}
+
+void GamePool::Recycle(std::unique_ptr<Minesweeper> game) noexcept {
+    const size_t size_class = GetSizeClass(game->GetWidth(), game->GetHeight());
+    if (size_class >= idle_.size()) {
+        return;
+    }
+    auto &games = idle_[size_class];
+    if (games.size() >= std::min(max_idle_per_class_, games.capacity())) {
+        return;
+    }
+    game->ResetOptions();
+    games.push_back(std::move(game));
+}
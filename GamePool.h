@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Minesweeper.h"
+
+#include <memory>
+#include <vector>
+
+class GamePool {
+public:
+    class Lease {
+    public:
+        Lease() = default;
+
+        Lease(Lease &&other) noexcept;
+
+        Lease &operator=(Lease &&other) noexcept;
+
+        ~Lease();
+
+        Minesweeper *Get() const noexcept;
+
+        Minesweeper &operator*() const noexcept;
+
+        Minesweeper *operator->() const noexcept;
+
+        explicit operator bool() const noexcept;
+
+    private:
+        friend class GamePool;
+
+        GamePool *pool_{nullptr};
+        std::unique_ptr<Minesweeper> game_;
+
+        Lease(GamePool *pool, std::unique_ptr<Minesweeper> game) noexcept;
+
+        void Release() noexcept;
+    };
+
+    explicit GamePool(size_t max_idle_per_class = 64);
+
+    GamePool(const GamePool &) = delete;
+
+    GamePool &operator=(const GamePool &) = delete;
+
+    Lease Acquire(size_t width, size_t height, size_t mines_count);
+
+    Lease Acquire(size_t width, size_t height, size_t mines_count, uint64_t seed,
+                  Minesweeper::MinePlacement placement = Minesweeper::MinePlacement::IMMEDIATE);
+
+    size_t IdleCount() const noexcept;
+
+private:
+    size_t max_idle_per_class_;
+    std::vector<std::vector<std::unique_ptr<Minesweeper>>> idle_;
+
+    static size_t GetSizeClass(size_t width, size_t height) noexcept;
+
+    std::unique_ptr<Minesweeper> TakeIdle(size_t width, size_t height);
+
+    void Recycle(std::unique_ptr<Minesweeper> game) noexcept;
+};
@@ -0,0 +1,166 @@
+#include "GameServer.h"
+
+#include <future>
+#include <stdexcept>
+
+GameServer::GameServer(size_t shards_count) {
+    shards_count = shards_count ? shards_count : 1;
+    shards_.reserve(shards_count);
+    for (size_t i = 0; i < shards_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+    for (auto &shard: shards_) {
+        shard->worker = std::thread([this, &shard = *shard] { Run(shard); });
+    }
+}
+
+GameServer::~GameServer() {
+    stopping_.store(true, std::memory_order_release);
+    for (auto &shard: shards_) {
+        shard->signal.fetch_add(1, std::memory_order_release);
+        shard->signal.notify_one();
+    }
+    for (auto &shard: shards_) {
+        shard->worker.join();
+    }
+}
+
+void GameServer::Submit(const Command &command) {
+    Submit(std::span<const Command>(&command, 1));
+}
+
+void GameServer::Submit(std::span<const Command> commands) {
+    std::vector<std::vector<Command>> batches(shards_.size());
+    for (const auto &command: commands) {
+        batches[ShardOf(command.game_id)].push_back(command);
+    }
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        if (!batches[i].empty()) {
+            Push(*shards_[i], Task{.commands = std::move(batches[i])});
+        }
+    }
+}
+
+void GameServer::Visit(GameId game_id, Visitor visitor) {
+    Push(*shards_[ShardOf(game_id)], Task{.game_id = game_id, .visitor = std::move(visitor)});
+}
+
+void GameServer::Flush() {
+    std::vector<std::promise<void>> done(shards_.size());
+    std::vector<std::future<void>> futures;
+    futures.reserve(shards_.size());
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        futures.push_back(done[i].get_future());
+        Push(*shards_[i], Task{.visitor = [&promise = done[i]](const Minesweeper *) { promise.set_value(); }});
+    }
+    for (auto &future: futures) {
+        future.wait();
+    }
+}
+
+size_t GameServer::ShardsCount() const noexcept {
+    return shards_.size();
+}
+
+size_t GameServer::ShardOf(GameId game_id) const noexcept {
+    return static_cast<size_t>(Xoshiro256::SplitMix64(game_id) % shards_.size());
+}
+
+size_t GameServer::RejectedCount() const noexcept {
+    return rejected_.load(std::memory_order_relaxed);
+}
+
+void GameServer::Push(Shard &shard, Task task) {
+    shard.queue.Push(std::move(task));
+    shard.signal.fetch_add(1, std::memory_order_release);
+    shard.signal.notify_one();
+}
+
+void GameServer::Run(Shard &shard) {
+    Task task;
+    for (;;) {
+        const uint32_t signal = shard.signal.load(std::memory_order_acquire);
+        while (shard.queue.TryPop(task)) {
+            Execute(shard, task);
+        }
+        if (stopping_.load(std::memory_order_acquire)) {
+            break;
+        }
+        shard.signal.wait(signal, std::memory_order_acquire);
+    }
+    while (shard.queue.TryPop(task)) {
+        Execute(shard, task);
+    }
+    shard.games.clear();
+}
+
+void GameServer::Execute(Shard &shard, Task &task) {
+    const auto &commands = task.commands;
+    for (size_t i = 0; i < commands.size();) {
+        if (!IsMove(commands[i])) {
+            try {
+                Execute(shard, commands[i]);
+            } catch (const std::exception &) {
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+            }
+            ++i;
+            continue;
+        }
+        const GameId game_id = commands[i].game_id;
+        shard.moves.clear();
+        for (; i < commands.size() && IsMove(commands[i]) && commands[i].game_id == game_id; ++i) {
+            shard.moves.push_back(Minesweeper::Move{.type = ToMoveType(commands[i].type), .cell = commands[i].cell});
+        }
+        ApplyMoves(shard, game_id);
+    }
+    if (task.visitor) {
+        const auto it = shard.games.find(task.game_id);
+        try {
+            task.visitor(it == shard.games.end() ? nullptr : it->second.Get());
+        } catch (const std::exception &) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    task = Task{};
+}
+
+void GameServer::Execute(Shard &shard, const Command &command) {
+    if (command.type == CommandType::NEW_GAME) {
+        auto game = command.seed
+                    ? shard.pool.Acquire(command.width, command.height, command.mines_count, *command.seed)
+                    : shard.pool.Acquire(command.width, command.height, command.mines_count);
+        shard.games.insert_or_assign(command.game_id, std::move(game));
+    } else if (command.type == CommandType::REMOVE_GAME) {
+        shard.games.erase(command.game_id);
+    }
+}
+
+void GameServer::ApplyMoves(Shard &shard, GameId game_id) {
+    const auto it = shard.games.find(game_id);
+    if (it == shard.games.end()) {
+        rejected_.fetch_add(shard.moves.size(), std::memory_order_relaxed);
+        return;
+    }
+    size_t rejected = 0;
+    for (const auto result: it->second->ApplyMoves(shard.moves)) {
+        rejected += result == Minesweeper::MoveResult::OUT_OF_BOUNDS;
+    }
+    if (rejected) {
+        rejected_.fetch_add(rejected, std::memory_order_relaxed);
+    }
+}
+
+bool GameServer::IsMove(const Command &command) noexcept {
+    return command.type == CommandType::OPEN_CELL || command.type == CommandType::MARK_CELL ||
+           command.type == CommandType::CHORD_CELL;
+}
+
+Minesweeper::MoveType GameServer::ToMoveType(CommandType type) noexcept {
+    if (type == CommandType::MARK_CELL) {
+        return Minesweeper::MoveType::MARK;
+    }
+    if (type == CommandType::CHORD_CELL) {
+        return Minesweeper::MoveType::CHORD;
+    }
+    return Minesweeper::MoveType::OPEN;
+}
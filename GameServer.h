@@ -0,0 +1,96 @@
+#pragma once
+
+#include "GamePool.h"
+#include "Minesweeper.h"
+#include "MpscQueue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class GameServer {
+public:
+    using GameId = uint64_t;
+
+    enum class CommandType {
+        NEW_GAME,
+        OPEN_CELL,
+        MARK_CELL,
+        CHORD_CELL,
+        REMOVE_GAME,
+    };
+
+    struct Command {
+        CommandType type = CommandType::OPEN_CELL;
+        GameId game_id = 0;
+        Minesweeper::Cell cell;
+        size_t width = 0;
+        size_t height = 0;
+        size_t mines_count = 0;
+        std::optional<uint64_t> seed;
+    };
+
+    using Visitor = std::function<void(const Minesweeper *)>;
+
+    explicit GameServer(size_t shards_count = std::thread::hardware_concurrency());
+
+    GameServer(const GameServer &) = delete;
+
+    GameServer &operator=(const GameServer &) = delete;
+
+    ~GameServer();
+
+    void Submit(const Command &command);
+
+    void Submit(std::span<const Command> commands);
+
+    void Visit(GameId game_id, Visitor visitor);
+
+    void Flush();
+
+    size_t ShardsCount() const noexcept;
+
+    size_t ShardOf(GameId game_id) const noexcept;
+
+    size_t RejectedCount() const noexcept;
+
+private:
+    struct Task {
+        std::vector<Command> commands = {};
+        GameId game_id = 0;
+        Visitor visitor = {};
+    };
+
+    struct Shard {
+        MpscQueue<Task> queue;
+        std::atomic<uint32_t> signal{0};
+        GamePool pool;
+        std::unordered_map<GameId, GamePool::Lease> games;
+        std::vector<Minesweeper::Move> moves;
+        std::thread worker;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<size_t> rejected_{0};
+
+    void Push(Shard &shard, Task task);
+
+    void Run(Shard &shard);
+
+    void Execute(Shard &shard, Task &task);
+
+    void Execute(Shard &shard, const Command &command);
+
+    void ApplyMoves(Shard &shard, GameId game_id);
+
+    static bool IsMove(const Command &command) noexcept;
+
+    static Minesweeper::MoveType ToMoveType(CommandType type) noexcept;
+};
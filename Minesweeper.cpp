@@ -1,28 +1,138 @@
-#include "minesweeper.h"
+#include "Minesweeper.h"
 
-#include <ctime>
-#include <queue>
+#include "BoardGenerator.h"
+#include "Snapshot.h"
+#include "Varint.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <random>
 #include <stdexcept>
 #include <tuple>
 
+#ifdef MINESWEEPER_STATS
+#define MINESWEEPER_STAT(statement) statement
+#else
+#define MINESWEEPER_STAT(statement)
+#endif
+
+namespace {
+
+using Word = BitPlane::Word;
+
+constexpr Word kHighBit = Word{1} << (BitPlane::kWordBits - 1);
+
+constexpr std::array<char, 10> kMinesNearSymbols = {'.', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+// mines_near has a one-cell border of kOutsideField around the board, so
+// neighbour walks test that border instead of clamping every coordinate.
+constexpr uint8_t kOutsideField = 0xff;
+
+constexpr std::array<int, 8> kNeighborDx = {-1, 0, 1, -1, 1, -1, 0, 1};
+
+constexpr std::array<int, 8> kNeighborDy = {-1, -1, -1, 0, 0, 1, 1, 1};
+
+constexpr const char *kCorruptedJournal = "Corrupted journal";
+
+std::atomic<uint64_t> last_deal_id{0};
+
+uint64_t NextDealId() noexcept {
+    return last_deal_id.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+Word FillTowardsHigh(Word gen, Word pro) noexcept {
+    gen |= pro & (gen << 1);
+    pro &= pro << 1;
+    gen |= pro & (gen << 2);
+    pro &= pro << 2;
+    gen |= pro & (gen << 4);
+    pro &= pro << 4;
+    gen |= pro & (gen << 8);
+    pro &= pro << 8;
+    gen |= pro & (gen << 16);
+    pro &= pro << 16;
+    return gen | (pro & (gen << 32));
+}
+
+Word FillTowardsLow(Word gen, Word pro) noexcept {
+    gen |= pro & (gen >> 1);
+    pro &= pro >> 1;
+    gen |= pro & (gen >> 2);
+    pro &= pro >> 2;
+    gen |= pro & (gen >> 4);
+    pro &= pro >> 4;
+    gen |= pro & (gen >> 8);
+    pro &= pro >> 8;
+    gen |= pro & (gen >> 16);
+    pro &= pro >> 16;
+    return gen | (pro & (gen >> 32));
+}
+
+void DilateRow(const Word *row, Word *out, size_t words) noexcept {
+    for (size_t w = 0; w < words; ++w) {
+        Word carry_in = w ? row[w - 1] >> (BitPlane::kWordBits - 1) : 0;
+        Word carry_out = w + 1 < words ? row[w + 1] << (BitPlane::kWordBits - 1) : 0;
+        out[w] = row[w] | (row[w] << 1) | carry_in | (row[w] >> 1) | carry_out;
+    }
+}
+
+void FillRuns(Word *row, const Word *mask, size_t words) noexcept {
+    for (size_t w = 0; w < words; ++w) {
+        if (w && (row[w - 1] & kHighBit) && (mask[w] & 1)) {
+            row[w] |= 1;
+        }
+        row[w] = FillTowardsHigh(row[w], mask[w]);
+    }
+    for (size_t w = words; w-- > 0;) {
+        if (w + 1 < words && (row[w + 1] & 1) && (mask[w] & kHighBit)) {
+            row[w] |= kHighBit;
+        }
+        row[w] = FillTowardsLow(row[w], mask[w]);
+    }
+}
+
+uint64_t NextRandomSeed() {
+    thread_local uint64_t state = (uint64_t{std::random_device()()} << 32) | std::random_device()();
+    return Xoshiro256::SplitMix64(state);
+}
+
+}  // namespace
+
 bool Minesweeper::Cell::operator==(const Cell &other) const noexcept {
     return std::tie(x, y) == std::tie(other.x, other.y);
 }
 
 size_t Minesweeper::CellHash::operator()(const Cell &cell) const noexcept {
-    const size_t val = 1000000;
-    return cell.x * val + cell.y;
+    uint64_t state = (static_cast<uint64_t>(cell.x) << 32) ^ cell.y;
+    return static_cast<size_t>(Xoshiro256::SplitMix64(state));
 }
 
-void Minesweeper::FieldDefinition(size_t mines_count) {
+void Minesweeper::FieldDefinition(size_t mines_count, MinePlacement placement) {
+    CheckFieldSize();
     if (mines_count > height_ * width_) {
         throw std::runtime_error("Too many mines");
     }
-    FillMines(mines_count);
+    MINESWEEPER_STAT(const auto started = Clock::now());
+    gen_.Seed(seed_);
+    if (placement == MinePlacement::FIRST_CLICK_SAFE) {
+        FillMines(0);
+        FillMinesNear();
+        mines_count_ = mines_count;
+        mines_pending_ = mines_count != 0;
+    } else {
+        FillMines(mines_count);
+        FillMinesNear();
+    }
     FillClosed();
+    MINESWEEPER_STAT(instrumentation_.field_definition_time += Clock::now() - started);
 }
 
 void Minesweeper::FieldDefinition(const std::vector<Cell> &cells_with_mines) {
+    CheckFieldSize();
     if (cells_with_mines.size() > height_ * width_) {
         throw std::runtime_error("Too many mines");
     }
@@ -31,20 +141,63 @@ void Minesweeper::FieldDefinition(const std::vector<Cell> &cells_with_mines) {
             throw std::runtime_error("Incorrect mine position");
         }
     }
-    std::copy(cells_with_mines.begin(), cells_with_mines.end(),
-              std::inserter(cells_with_mines_, cells_with_mines_.begin()));
+    MINESWEEPER_STAT(const auto started = Clock::now());
+    BitPlane &mines = OwnLayout().mines;
+    mines.Assign(width_, height_);
+    for (const auto &cell: cells_with_mines) {
+        if (!IsMine(cell)) {
+            mines.Set(cell.x, cell.y);
+            ++mines_count_;
+        }
+    }
+    FillMinesNear();
     FillClosed();
+    MINESWEEPER_STAT(instrumentation_.field_definition_time += Clock::now() - started);
 }
 
 Minesweeper::Minesweeper(size_t width, size_t height, const std::vector<Cell> &cells_with_mines)
-        : width_(width), height_(height),
-          cells_with_mines_(cells_with_mines.begin(), cells_with_mines.end()) {
+        : width_(width), height_(height) {
     FieldDefinition(cells_with_mines);
 }
 
-Minesweeper::Minesweeper(size_t width, size_t height, size_t mines_count) : width_(width),
-                                                                            height_(height) {
-    FieldDefinition(mines_count);
+Minesweeper::Minesweeper(size_t width, size_t height, size_t mines_count)
+        : Minesweeper(width, height, mines_count, NextRandomSeed()) {
+}
+
+Minesweeper::Minesweeper(size_t width, size_t height, size_t mines_count, uint64_t seed,
+                         MinePlacement placement)
+        : width_(width), height_(height), seed_(seed) {
+    FieldDefinition(mines_count, placement);
+}
+
+Minesweeper::Minesweeper(const SnapshotView &snapshot) {
+    Restore(snapshot);
+}
+
+Minesweeper Minesweeper::Fork() const {
+    Minesweeper fork;
+    fork.width_ = width_;
+    fork.height_ = height_;
+    fork.clock_ = clock_;
+    fork.start_time_ = start_time_;
+    fork.finish_time_ = finish_time_;
+    fork.status_ = status_;
+    fork.cascade_strategy_ = cascade_strategy_;
+    fork.mines_count_ = mines_count_;
+    fork.mines_pending_ = mines_pending_;
+    fork.marked_count_ = marked_count_;
+    fork.closed_count_ = closed_count_;
+    fork.opened_count_ = opened_count_;
+    fork.layout_ = layout_;
+    fork.marked_ = marked_;
+    fork.closed_ = closed_;
+    fork.change_history_limit_ = change_history_limit_;
+    fork.track_changes_ = track_changes_;
+    fork.deal_id_ = NextDealId();
+    fork.journal_time_ = journal_time_;
+    fork.seed_ = seed_;
+    fork.gen_ = gen_;
+    return fork;
 }
 
 void Minesweeper::NewGame(size_t width, size_t height, const std::vector<Cell> &cells_with_mines) {
@@ -54,23 +207,98 @@ void Minesweeper::NewGame(size_t width, size_t height, const std::vector<Cell> &
 }
 
 void Minesweeper::NewGame(size_t width, size_t height, size_t mines_count) {
+    NewGame(width, height, mines_count, NextRandomSeed());
+}
+
+void Minesweeper::NewGame(size_t width, size_t height, size_t mines_count, uint64_t seed,
+                          MinePlacement placement) {
     ResetValues();
     SetNewBoundary(width, height);
-    FieldDefinition(mines_count);
+    seed_ = seed;
+    FieldDefinition(mines_count, placement);
+}
+
+void Minesweeper::Restore(const SnapshotView &snapshot) {
+    const SnapshotHeader &header = snapshot.Header();
+    ResetValues();
+    SetNewBoundary(header.width, header.height);
+    CheckFieldSize();
+    BitPlane &mines = OwnLayout().mines;
+    mines.Assign(width_, height_);
+    std::copy_n(snapshot.Mines(), snapshot.PlaneWords(), mines.Data());
+    mines_count_ = header.mines_count;
+    FillMinesNear();
+    FillClosed();
+    std::copy_n(snapshot.Closed(), snapshot.PlaneWords(), closed_.Data());
+    std::copy_n(snapshot.Marked(), snapshot.PlaneWords(), marked_.Data());
+    marked_count_ = marked_.Count();
+    closed_count_ = closed_.Count();
+    opened_count_ = height_ * width_ - closed_count_;
+    mines_pending_ = header.mines_pending;
+    seed_ = header.seed;
+    gen_.SetState(header.random_state);
+    status_ = static_cast<GameStatus>(header.status);
+    cascade_strategy_ = static_cast<CascadeStrategy>(header.cascade_strategy);
+    if (status_ != GameStatus::NOT_STARTED) {
+        const auto elapsed = header.version == 1
+                             ? Clock::duration(std::chrono::seconds(header.elapsed_time))
+                             : Clock::duration(std::chrono::nanoseconds(header.elapsed_time));
+        start_time_ = Now() - elapsed;
+        finish_time_ = start_time_ + elapsed;
+    }
+}
+
+size_t Minesweeper::GetSnapshotSize() const noexcept {
+    return SnapshotView::Size(width_, height_);
+}
+
+void Minesweeper::WriteSnapshot(std::span<std::byte> buffer) const {
+    if (buffer.size() < GetSnapshotSize()) {
+        throw std::runtime_error("Snapshot buffer is too small");
+    }
+    const SnapshotHeader header{
+            .width = width_,
+            .height = height_,
+            .words_per_row = closed_.WordsPerRow(),
+            .mines_count = mines_count_,
+            .marked_count = marked_count_,
+            .closed_count = closed_count_,
+            .opened_count = opened_count_,
+            .seed = seed_,
+            .elapsed_time = std::chrono::duration_cast<std::chrono::nanoseconds>(GetGameDuration()).count(),
+            .random_state = gen_.GetState(),
+            .status = static_cast<uint8_t>(status_),
+            .mines_pending = mines_pending_,
+            .cascade_strategy = static_cast<uint8_t>(cascade_strategy_),
+    };
+    std::byte *out = buffer.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    const BitPlane &mines = layout_->mines;
+    for (const BitPlane *plane: {&mines, &closed_, &marked_}) {
+        std::copy_n(reinterpret_cast<const std::byte *>(plane->Data()), plane->WordsCount() * sizeof(BitPlane::Word), out);
+        out += plane->WordsCount() * sizeof(BitPlane::Word);
+    }
+}
+
+std::vector<std::byte> Minesweeper::Snapshot() const {
+    std::vector<std::byte> result(GetSnapshotSize());
+    WriteSnapshot(result);
+    return result;
 }
 
 void Minesweeper::ResetValues() noexcept {
     width_ = 0;
     height_ = 0;
-    start_time_ = 0;
-    finish_time_ = 0;
+    start_time_ = {};
+    finish_time_ = {};
     status_ = GameStatus::NOT_STARTED;
-    marked_cells_.clear();
-    marked_cells_.rehash(0);
-    closed_cells_.clear();
-    closed_cells_.rehash(0);
-    cells_with_mines_.clear();
-    cells_with_mines_.rehash(0);
+    seed_ = 0;
+    mines_count_ = 0;
+    mines_pending_ = false;
+    marked_count_ = 0;
+    closed_count_ = 0;
+    opened_count_ = 0;
 }
 
 void Minesweeper::SetNewBoundary(size_t width, size_t height) noexcept {
@@ -80,20 +308,98 @@ void Minesweeper::SetNewBoundary(size_t width, size_t height) noexcept {
 
 void Minesweeper::StartGame() noexcept {
     status_ = GameStatus::IN_PROGRESS;
-    start_time_ = std::time(NULL);
+    start_time_ = Now();
+    journal_time_ = start_time_;
 }
 
-void Minesweeper::Defeat() noexcept {
+void Minesweeper::Defeat() {
     status_ = GameStatus::DEFEAT;
-    finish_time_ = std::time(NULL);
+    finish_time_ = Now();
+    TrackMines();
+}
+
+void Minesweeper::TrackMines() {
+    for (size_t y = 0; track_changes_ && y < height_; ++y) {
+        const Word *row = layout_->mines.Row(y);
+        for (size_t w = 0; w < layout_->mines.WordsPerRow(); ++w) {
+            for (Word bits = row[w]; bits; bits &= bits - 1) {
+                changes_.push_back(static_cast<CellIndex>(y * width_ + w * BitPlane::kWordBits + std::countr_zero(bits)));
+            }
+        }
+    }
 }
 
 void Minesweeper::VictoryCheck() noexcept {
-    if (closed_cells_.size() != cells_with_mines_.size()) {
+    if (status_ != GameStatus::IN_PROGRESS || closed_count_ != mines_count_) {
         return;
     }
     status_ = GameStatus::VICTORY;
-    finish_time_ = std::time(NULL);
+    finish_time_ = Now();
+}
+
+void Minesweeper::OpenClosed(const Cell &cell) {
+    closed_.Reset(cell.x, cell.y);
+    --closed_count_;
+    ++opened_count_;
+    if (track_changes_) {
+        changes_.push_back(ToIndex(cell));
+    }
+    if (undo_enabled_) {
+        undo_cells_.push_back(ToIndex(cell));
+    }
+}
+
+void Minesweeper::OpenWord(size_t y, size_t word, BitPlane::Word bits) {
+    if (!bits) {
+        return;
+    }
+    const auto opened = static_cast<size_t>(std::popcount(bits));
+    closed_.Row(y)[word] &= ~bits;
+    closed_count_ -= opened;
+    opened_count_ += opened;
+    for (; (track_changes_ || undo_enabled_) && bits; bits &= bits - 1) {
+        const auto index = static_cast<CellIndex>(y * width_ + word * BitPlane::kWordBits + std::countr_zero(bits));
+        if (track_changes_) {
+            changes_.push_back(index);
+        }
+        if (undo_enabled_) {
+            undo_cells_.push_back(index);
+        }
+    }
+}
+
+void Minesweeper::CommitRevision() {
+    if (!track_changes_) {
+        ++first_revision_;
+        return;
+    }
+    if (changes_.size() != revision_offsets_.back()) {
+        revision_offsets_.push_back(changes_.size());
+        CompactChanges();
+    }
+}
+
+void Minesweeper::CompactChanges() {
+    // Dropping starts at twice the kept history, so each logged cell is moved
+    // at most once on average.
+    const size_t keep_cells = std::max<size_t>(height_ * width_, 64);
+    const size_t revisions = revision_offsets_.size() - 1;
+    if (revisions <= 2 * change_history_limit_ && changes_.size() <= 2 * keep_cells) {
+        return;
+    }
+    size_t dropped = revisions > change_history_limit_ ? revisions - change_history_limit_ : 0;
+    if (changes_.size() > keep_cells) {
+        const auto kept = std::lower_bound(revision_offsets_.begin(), revision_offsets_.end(),
+                                           changes_.size() - keep_cells);
+        dropped = std::max(dropped, static_cast<size_t>(kept - revision_offsets_.begin()));
+    }
+    const size_t base = revision_offsets_[dropped];
+    changes_.erase(changes_.begin(), changes_.begin() + static_cast<ptrdiff_t>(base));
+    revision_offsets_.erase(revision_offsets_.begin(), revision_offsets_.begin() + static_cast<ptrdiff_t>(dropped));
+    for (size_t &offset: revision_offsets_) {
+        offset -= base;
+    }
+    first_revision_ += dropped;
 }
 
 bool Minesweeper::IsCorrectBoundary(const Cell &cell) const noexcept {
@@ -101,148 +407,965 @@ bool Minesweeper::IsCorrectBoundary(const Cell &cell) const noexcept {
 }
 
 bool Minesweeper::IsMine(const Cell &cell) const noexcept {
-    return cells_with_mines_.contains(cell);
+    return layout_->mines.Test(cell.x, cell.y);
 }
 
 bool Minesweeper::IsMarked(const Cell &cell) const noexcept {
-    return marked_cells_.contains(cell);
+    return marked_.Test(cell.x, cell.y);
 }
 
 bool Minesweeper::IsClosed(const Cell &cell) const noexcept {
-    return closed_cells_.contains(cell);
+    return closed_.Test(cell.x, cell.y);
 }
 
 bool Minesweeper::IsOpened(const Cell &cell) const noexcept {
     return !IsClosed(cell);
 }
 
+bool Minesweeper::IsFillable(const Cell &cell) const noexcept {
+    return IsClosed(cell) && !IsMarked(cell) && !CalcMinesNear(cell);
+}
+
 bool Minesweeper::IsFinishedGame() const noexcept {
     return (status_ == GameStatus::VICTORY || status_ == GameStatus::DEFEAT);
 }
 
 size_t Minesweeper::CalcMinesNear(const Cell &cell) const noexcept {
-    size_t result = 0;
-    for (int i = -1; i <= 1; ++i) {
-        for (int j = -1; j <= 1; ++j) {
-            Cell neighbor_cell{.x = cell.x + i, .y = cell.y + j};
-            if (IsCorrectBoundary(neighbor_cell) && IsMine(neighbor_cell)) {
-                ++result;
-            }
-        }
+    MINESWEEPER_STAT(++instrumentation_.calc_mines_near_calls);
+    return layout_->mines_near[PaddedIndex(cell)];
+}
+
+size_t Minesweeper::PaddedIndex(const Cell &cell) const noexcept {
+    return (cell.y + 1) * (width_ + 2) + cell.x + 1;
+}
+
+void Minesweeper::CheckFieldSize() const {
+    if (width_ && height_ > std::numeric_limits<CellIndex>::max() / width_) {
+        throw std::runtime_error("Field is too large");
     }
-    return result;
 }
 
-void Minesweeper::FillClosed() noexcept {
-    closed_cells_.reserve(height_ * width_);
-    for (size_t y = 0; y < height_; ++y) {
-        for (size_t x = 0; x < width_; ++x) {
-            closed_cells_.insert(Cell{.x = x, .y = y});
+void Minesweeper::FillClosed() {
+    closed_.Assign(width_, height_, true);
+    marked_.Assign(width_, height_);
+    closed_count_ = height_ * width_;
+    opened_count_ = 0;
+    fill_stack_.clear();
+    fill_stack_.reserve(2 * height_);
+    // Revisions keep counting across deals, so a client still at one of the
+    // last board's revisions is below GetOldestRevision() and renders again.
+    first_revision_ = GetRevision() + 1;
+    deal_id_ = NextDealId();
+    changes_.clear();
+    revision_offsets_.assign(1, 0);
+    journal_.clear();
+    journal_time_ = {};
+    ClearUndo();
+}
+
+Minesweeper::Layout &Minesweeper::OwnLayout() {
+    // Callers rebuild the whole layout, so a shared one is replaced rather
+    // than copied.
+    if (!layout_ || layout_.use_count() != 1) {
+        layout_ = std::make_shared<Layout>();
+    }
+    return *layout_;
+}
+
+void Minesweeper::FillMines(size_t mines_count, std::span<const size_t> excluded) {
+    BoardGenerator::PlaceMines(OwnLayout().mines, width_, height_, mines_count, gen_, excluded);
+    mines_count_ = mines_count;
+}
+
+void Minesweeper::PlacePendingMines(const Cell &first_cell) {
+    MINESWEEPER_STAT(const auto started = Clock::now());
+    std::array<size_t, 9> excluded;
+    size_t excluded_count = 0;
+    for (size_t y = (first_cell.y ? first_cell.y - 1 : 0); y <= first_cell.y + 1 && y < height_; ++y) {
+        for (size_t x = (first_cell.x ? first_cell.x - 1 : 0); x <= first_cell.x + 1 && x < width_; ++x) {
+            excluded[excluded_count++] = y * width_ + x;
         }
     }
+    if (height_ * width_ - excluded_count < mines_count_) {
+        excluded[0] = first_cell.y * width_ + first_cell.x;
+        excluded_count = 1;
+    }
+    if (height_ * width_ - excluded_count < mines_count_) {
+        excluded_count = 0;
+    }
+    FillMines(mines_count_, std::span<const size_t>(excluded.data(), excluded_count));
+    FillMinesNear();
+    mines_pending_ = false;
+    MINESWEEPER_STAT(instrumentation_.field_definition_time += Clock::now() - started);
 }
 
-void Minesweeper::FillMines(size_t mines_count) noexcept {
-    if (!mines_count) {
-        return;
+void Minesweeper::FillMinesNear() {
+    Layout &layout = *layout_;
+    const size_t stride = width_ + 2;
+    layout.mines_near.assign((height_ + 2) * stride, kOutsideField);
+    for (size_t k = 0; k < layout.neighbor_offsets.size(); ++k) {
+        layout.neighbor_offsets[k] = kNeighborDy[k] * static_cast<ptrdiff_t>(stride) + kNeighborDx[k];
     }
-    std::vector<Cell> possible_mine;
-    possible_mine.reserve(height_ * width_);
-    for (size_t x = 0; x < width_; ++x) {
+    if (!mines_count_) {
         for (size_t y = 0; y < height_; ++y) {
-            possible_mine.push_back(Cell{.x = x, .y = y});
+            std::fill_n(layout.mines_near.data() + PaddedIndex(Cell{.x = 0, .y = y}), width_, 0);
+        }
+        layout.empty.Assign(width_, height_, true);
+        return;
+    }
+    BoardGenerator::CountMinesNear(layout.mines, layout.mines_near.data() + stride + 1, stride, layout_scratch_);
+    layout.empty.Assign(width_, height_);
+    for (size_t y = 0; y < height_; ++y) {
+        const uint8_t *near = layout.mines_near.data() + PaddedIndex(Cell{.x = 0, .y = y});
+        for (size_t x = 0; x < width_; ++x) {
+            if (!near[x]) {
+                layout.empty.Set(x, y);
+            }
         }
     }
-    std::shuffle(possible_mine.begin(), possible_mine.end(), gen_);
-    std::copy(possible_mine.begin(), possible_mine.begin() + static_cast<int64_t>(mines_count),
-              std::inserter(cells_with_mines_, cells_with_mines_.begin()));
 }
 
 void Minesweeper::MarkCell(const Cell &cell) {
     if (!IsCorrectBoundary(cell)) {
         throw std::runtime_error("A cell outside the field boundary");
     }
-    if (IsFinishedGame()) {
+    if (ApplyBoundedMove(Move{.type = MoveType::MARK, .cell = cell})) {
+        CommitRevision();
+    }
+}
+
+void Minesweeper::ChordCell(const Cell &cell) {
+    if (!IsCorrectBoundary(cell)) {
+        throw std::runtime_error("A cell outside the field boundary");
+    }
+    if (ApplyBoundedMove(Move{.type = MoveType::CHORD, .cell = cell})) {
+        CommitRevision();
+        VictoryCheck();
+    }
+}
+
+void Minesweeper::OpenCell(CellIndex index) {
+    if (index >= height_ * width_) {
+        throw std::runtime_error("A cell outside the field boundary");
+    }
+    OpenCell(ToCell(index));
+}
+
+void Minesweeper::MarkCell(CellIndex index) {
+    if (index >= height_ * width_) {
+        throw std::runtime_error("A cell outside the field boundary");
+    }
+    MarkCell(ToCell(index));
+}
+
+void Minesweeper::ChordCell(CellIndex index) {
+    if (index >= height_ * width_) {
+        throw std::runtime_error("A cell outside the field boundary");
+    }
+    ChordCell(ToCell(index));
+}
+
+char Minesweeper::GetCellSymbol(const Cell &cell) const {
+    if (!IsCorrectBoundary(cell)) {
+        throw std::runtime_error("A cell outside the field boundary");
+    }
+    return RenderCell(cell);
+}
+
+char Minesweeper::GetCellSymbol(CellIndex index) const {
+    if (index >= height_ * width_) {
+        throw std::runtime_error("A cell outside the field boundary");
+    }
+    return RenderCell(ToCell(index));
+}
+
+Minesweeper::CellIndex Minesweeper::ToIndex(const Cell &cell) const noexcept {
+    return static_cast<CellIndex>(cell.y * width_ + cell.x);
+}
+
+Minesweeper::Cell Minesweeper::ToCell(CellIndex index) const noexcept {
+    return Cell{.x = index % width_, .y = index / width_};
+}
+
+void Minesweeper::OpenCell(const Cell &cell) {
+    if (!IsCorrectBoundary(cell)) {
+        throw std::runtime_error("A cell outside the field boundary");
+    }
+    if (ApplyBoundedMove(Move{.type = MoveType::OPEN, .cell = cell})) {
+        CommitRevision();
+        VictoryCheck();
+    }
+}
+
+std::vector<Minesweeper::MoveResult> Minesweeper::ApplyMoves(std::span<const Move> moves) {
+    std::vector<MoveResult> results(moves.size(), MoveResult::IGNORED);
+    bool applied_any = false;
+    for (size_t i = 0; i < moves.size() && !IsFinishedGame(); ++i) {
+        results[i] = IsCorrectBoundary(moves[i].cell) ? ApplyListedMove(moves[i]) : MoveResult::OUT_OF_BOUNDS;
+        applied_any |= results[i] != MoveResult::IGNORED && results[i] != MoveResult::OUT_OF_BOUNDS;
+    }
+    if (applied_any) {
+        CommitRevision();
+    }
+    return results;
+}
+
+std::vector<Minesweeper::MoveResult> Minesweeper::ApplyMoves(std::span<const IndexMove> moves) {
+    std::vector<MoveResult> results(moves.size(), MoveResult::IGNORED);
+    bool applied_any = false;
+    for (size_t i = 0; i < moves.size() && !IsFinishedGame(); ++i) {
+        results[i] = moves[i].index < height_ * width_
+                     ? ApplyListedMove(Move{.type = moves[i].type, .cell = ToCell(moves[i].index)})
+                     : MoveResult::OUT_OF_BOUNDS;
+        applied_any |= results[i] != MoveResult::IGNORED && results[i] != MoveResult::OUT_OF_BOUNDS;
+    }
+    if (applied_any) {
+        CommitRevision();
+    }
+    return results;
+}
+
+Minesweeper::MoveResult Minesweeper::ApplyListedMove(const Move &move) {
+    if (!ApplyBoundedMove(move)) {
+        return MoveResult::IGNORED;
+    }
+    if (status_ == GameStatus::DEFEAT) {
+        return MoveResult::DEFEAT;
+    }
+    if (closed_count_ == mines_count_ && move.type != MoveType::MARK) {
+        VictoryCheck();
+        return MoveResult::VICTORY;
+    }
+    return MoveResult::APPLIED;
+}
+
+bool Minesweeper::ApplyBoundedMove(const Move &move) {
+    MINESWEEPER_STAT(const size_t opened_before = opened_count_);
+    const UndoRecord undo_record{
+            .move = move,
+            .status_before = status_,
+            .cells_begin = undo_cells_.size(),
+            .journal_size = journal_.size(),
+            .journal_time = journal_time_,
+            .mines_pending = mines_pending_,
+            .random_state = gen_.GetState(),
+            .logged_since = GetRevision(),
+    };
+    bool applied = false;
+    if (move.type == MoveType::MARK) {
+        applied = MarkBoundedCell(move.cell);
+    } else if (move.type == MoveType::CHORD) {
+        applied = ChordBoundedCell(move.cell);
+    } else {
+        applied = OpenBoundedCell(move.cell);
+    }
+    MINESWEEPER_STAT(if (applied) CountMove(opened_count_ - opened_before));
+    if (applied && undo_enabled_) {
+        RecordUndo(undo_record);
+    }
+    if (applied && journal_enabled_) {
+        WriteJournalRecord(move);
+    }
+    return applied;
+}
+
+void Minesweeper::WriteJournalRecord(const Move &move) {
+    const auto now = Now();
+    const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(now - journal_time_);
+    Varint::Write(journal_, static_cast<uint64_t>(delta.count()));
+    Varint::Write(journal_, (move.cell.y * width_ + move.cell.x) << 2 | static_cast<uint64_t>(move.type));
+    journal_time_ += delta;
+}
+
+void Minesweeper::EnableJournal(bool enabled) noexcept {
+    journal_enabled_ = enabled;
+}
+
+const std::vector<uint8_t> &Minesweeper::GetJournal() const noexcept {
+    return journal_;
+}
+
+void Minesweeper::EnableUndo(bool enabled) noexcept {
+    undo_enabled_ = enabled;
+    ClearUndo();
+}
+
+bool Minesweeper::CanUndo() const noexcept {
+    return undo_position_ != 0;
+}
+
+bool Minesweeper::CanRedo() const noexcept {
+    return undo_position_ < undo_records_.size();
+}
+
+bool Minesweeper::Undo() {
+    if (!CanUndo()) {
+        return false;
+    }
+    UndoRecord &record = undo_records_[--undo_position_];
+    record.status_after = status_;
+    const bool relogged = RelogChanges(record.logged_since);
+    track_changes_ &= !relogged;
+    if (status_ == GameStatus::DEFEAT) {
+        // The revealed mines render as closed cells again.
+        TrackMines();
+    }
+    FlipUndoCells(undo_position_);
+    if (record.mines_pending && !mines_pending_) {
+        // Taking back the first click takes back its mine placement too, so
+        // the journal still replays and Redo deals the same mines again.
+        const size_t mines_count = mines_count_;
+        FillMines(0);
+        FillMinesNear();
+        mines_count_ = mines_count;
+        mines_pending_ = true;
+        gen_.SetState(record.random_state);
+    }
+    status_ = record.status_before;
+    if (status_ == GameStatus::NOT_STARTED) {
+        start_time_ = {};
+    }
+    if (journal_.size() > record.journal_size) {
+        journal_.resize(record.journal_size);
+    }
+    journal_time_ = record.journal_time;
+    track_changes_ |= relogged;
+    CommitUndoRevision(record, relogged);
+    return true;
+}
+
+bool Minesweeper::Redo() {
+    if (!CanRedo()) {
+        return false;
+    }
+    UndoRecord &record = undo_records_[undo_position_];
+    const bool relogged = RelogChanges(record.logged_since);
+    track_changes_ &= !relogged;
+    if (status_ == GameStatus::NOT_STARTED) {
+        StartGame();
+    }
+    if (mines_pending_ && record.move.type == MoveType::OPEN) {
+        PlacePendingMines(record.move.cell);
+    }
+    FlipUndoCells(undo_position_++);
+    if (record.status_after == GameStatus::DEFEAT) {
+        Defeat();
+    } else if (record.move.type != MoveType::MARK) {
+        VictoryCheck();
+    }
+    if (journal_enabled_) {
+        WriteJournalRecord(record.move);
+    }
+    track_changes_ |= relogged;
+    CommitUndoRevision(record, relogged);
+    return true;
+}
+
+bool Minesweeper::RelogChanges(uint64_t revision) noexcept {
+    // Undo and Redo change back the cells a move logged. While those entries
+    // are still kept, every later revision is widened to start before them,
+    // so a rollback logs nothing and try-and-undo loops keep the log flat.
+    if (!track_changes_ || revision < first_revision_) {
+        return false;
+    }
+    const auto kept = revision_offsets_.begin() + static_cast<ptrdiff_t>(revision - first_revision_);
+    std::fill(kept + 1, revision_offsets_.end(), *kept);
+    return true;
+}
+
+void Minesweeper::CommitUndoRevision(UndoRecord &record, bool relogged) {
+    if (relogged) {
+        revision_offsets_.push_back(changes_.size());
+        CompactChanges();
         return;
     }
+    record.logged_since = GetRevision();
+    CommitRevision();
+}
+
+void Minesweeper::RecordUndo(UndoRecord record) {
+    // A new move drops the undone moves. Their cells sit between the current
+    // position and the cells this move has just appended.
+    if (CanRedo()) {
+        const size_t tail_begin = undo_records_[undo_position_].cells_begin;
+        undo_cells_.erase(undo_cells_.begin() + static_cast<ptrdiff_t>(tail_begin),
+                          undo_cells_.begin() + static_cast<ptrdiff_t>(record.cells_begin));
+        record.cells_begin = tail_begin;
+        undo_records_.resize(undo_position_);
+    }
+    undo_records_.push_back(record);
+    ++undo_position_;
+}
+
+void Minesweeper::FlipUndoCells(size_t position) {
+    // A move's cells are flipped back and forth: opened cells close and closed
+    // cells open, a mark is toggled.
+    const UndoRecord &record = undo_records_[position];
+    const size_t cells_end = position + 1 < undo_records_.size() ? undo_records_[position + 1].cells_begin
+                                                                 : undo_cells_.size();
+    for (size_t i = record.cells_begin; i < cells_end; ++i) {
+        const Cell cell = ToCell(undo_cells_[i]);
+        if (record.move.type == MoveType::MARK) {
+            marked_count_ = IsMarked(cell) ? marked_count_ - 1 : marked_count_ + 1;
+            marked_.Flip(cell.x, cell.y);
+        } else if (IsClosed(cell)) {
+            closed_.Reset(cell.x, cell.y);
+            --closed_count_;
+            ++opened_count_;
+        } else {
+            closed_.Set(cell.x, cell.y);
+            ++closed_count_;
+            --opened_count_;
+        }
+        if (track_changes_) {
+            changes_.push_back(undo_cells_[i]);
+        }
+    }
+}
+
+void Minesweeper::ClearUndo() noexcept {
+    undo_records_.clear();
+    undo_cells_.clear();
+    undo_position_ = 0;
+}
+
+Minesweeper Minesweeper::Replay(size_t width, size_t height, size_t mines_count, uint64_t seed,
+                                MinePlacement placement, std::span<const uint8_t> journal) {
+    Minesweeper game(width, height, mines_count, seed, placement);
+    game.replaying_ = true;
+    game.track_changes_ = false;
+    size_t offset = 0;
+    while (offset < journal.size()) {
+        game.replay_time_ += std::chrono::milliseconds(Varint::Read(journal, offset, kCorruptedJournal));
+        const uint64_t record = Varint::Read(journal, offset, kCorruptedJournal);
+        // The journal may come from an untrusted client, so the index is
+        // checked before it is split into coordinates.
+        if ((record & 3) > static_cast<uint64_t>(MoveType::CHORD) || (record >> 2) >= width * height) {
+            throw std::runtime_error(kCorruptedJournal);
+        }
+        const Move move{
+                .type = static_cast<MoveType>(record & 3),
+                .cell = game.ToCell(static_cast<CellIndex>(record >> 2)),
+        };
+        if (game.ApplyBoundedMove(move) && move.type != MoveType::MARK) {
+            game.VictoryCheck();
+        }
+    }
+    if (game.status_ == GameStatus::IN_PROGRESS) {
+        game.start_time_ = game.clock_() - (game.replay_time_ - game.start_time_);
+    }
+    game.replaying_ = false;
+    game.track_changes_ = true;
+    return game;
+}
+
+Minesweeper::Clock::time_point Minesweeper::Now() const noexcept {
+    return replaying_ ? replay_time_ : clock_();
+}
+
+bool Minesweeper::MarkBoundedCell(const Cell &cell) {
+    if (IsFinishedGame() || IsOpened(cell)) {
+        return false;
+    }
     if (status_ == GameStatus::NOT_STARTED) {
         StartGame();
     }
     if (Minesweeper::IsMarked(cell)) {
-        marked_cells_.erase(cell);
+        --marked_count_;
     } else {
-        marked_cells_.insert(cell);
+        ++marked_count_;
+    }
+    marked_.Flip(cell.x, cell.y);
+    if (track_changes_) {
+        changes_.push_back(ToIndex(cell));
+    }
+    if (undo_enabled_) {
+        undo_cells_.push_back(ToIndex(cell));
     }
+    return true;
 }
 
-void Minesweeper::OpenCell(const Cell &cell) {
-    if (!IsCorrectBoundary(cell)) {
-        throw std::runtime_error("A cell outside the field boundary");
-    }
+bool Minesweeper::OpenBoundedCell(const Cell &cell) {
     if (IsFinishedGame() || IsMarked(cell) || IsOpened(cell)) {
-        return;
+        return false;
     }
     if (status_ == GameStatus::NOT_STARTED) {
         StartGame();
     }
+    if (mines_pending_) {
+        PlacePendingMines(cell);
+    }
     if (IsMine(cell)) {
         Defeat();
+        return true;
+    }
+    if (CalcMinesNear(cell)) {
+        OpenClosed(cell);
+    } else {
+        fill_stack_.push_back(ToIndex(cell));
+        Cascade();
+    }
+    return true;
+}
+
+bool Minesweeper::ChordBoundedCell(const Cell &cell) {
+    if (IsFinishedGame() || IsClosed(cell) || IsMarked(cell)) {
+        return false;
+    }
+    const Layout &layout = *layout_;
+    const uint8_t *near = layout.mines_near.data() + PaddedIndex(cell);
+    size_t marked_near = 0;
+    bool closed_near = false;
+    bool mine_near = false;
+    for (size_t k = 0; k < layout.neighbor_offsets.size(); ++k) {
+        if (near[layout.neighbor_offsets[k]] == kOutsideField) {
+            continue;
+        }
+        const Cell neighbor_cell{.x = cell.x + kNeighborDx[k], .y = cell.y + kNeighborDy[k]};
+        if (IsMarked(neighbor_cell)) {
+            ++marked_near;
+        } else if (IsClosed(neighbor_cell)) {
+            closed_near = true;
+            mine_near |= IsMine(neighbor_cell);
+        }
+    }
+    if (!closed_near || marked_near != *near) {
+        return false;
+    }
+    if (mine_near) {
+        Defeat();
+        return true;
+    }
+    for (size_t k = 0; k < layout.neighbor_offsets.size(); ++k) {
+        const uint8_t neighbor_near = near[layout.neighbor_offsets[k]];
+        if (neighbor_near == kOutsideField) {
+            continue;
+        }
+        const Cell neighbor_cell{.x = cell.x + kNeighborDx[k], .y = cell.y + kNeighborDy[k]};
+        if (!IsClosed(neighbor_cell) || IsMarked(neighbor_cell)) {
+            continue;
+        }
+        if (neighbor_near) {
+            OpenClosed(neighbor_cell);
+        } else {
+            fill_stack_.push_back(ToIndex(neighbor_cell));
+        }
+    }
+    Cascade();
+    return true;
+}
+
+void Minesweeper::Cascade() {
+    if (cascade_strategy_ == CascadeStrategy::BITBOARD) {
+        BitboardFill();
+    } else {
+        FloodFill();
+    }
+}
+
+void Minesweeper::FloodFill() {
+    // Every seed is a closed unmarked empty cell. Its whole horizontal run of
+    // such cells is opened at once, the run's neighbours in the same row and
+    // in the rows above and below are opened, and each empty run found there
+    // becomes a new seed.
+    while (!fill_stack_.empty()) {
+        MINESWEEPER_STAT(instrumentation_.peak_fill_stack = std::max(instrumentation_.peak_fill_stack, fill_stack_.size()));
+        const Cell seed = ToCell(fill_stack_.back());
+        fill_stack_.pop_back();
+        if (!IsClosed(seed)) {
+            continue;
+        }
+        const size_t y = seed.y;
+        size_t left = seed.x;
+        size_t right = seed.x;
+        while (left > 0 && IsFillable(Cell{.x = left - 1, .y = y})) {
+            --left;
+        }
+        while (right + 1 < width_ && IsFillable(Cell{.x = right + 1, .y = y})) {
+            ++right;
+        }
+        for (size_t x = left; x <= right; ++x) {
+            OpenClosed(Cell{.x = x, .y = y});
+        }
+        const size_t from = left ? left - 1 : left;
+        const size_t to = right + 1 < width_ ? right + 1 : right;
+        for (const size_t x: {from, to}) {
+            Cell border_cell{.x = x, .y = y};
+            if (IsClosed(border_cell) && !IsMarked(border_cell)) {
+                OpenClosed(border_cell);
+            }
+        }
+        for (const size_t row: {y - 1, y + 1}) {
+            if (row >= height_) {
+                continue;
+            }
+            for (size_t x = from; x <= to; ++x) {
+                Cell neighbor_cell{.x = x, .y = row};
+                if (!IsClosed(neighbor_cell) || IsMarked(neighbor_cell)) {
+                    continue;
+                }
+                if (CalcMinesNear(neighbor_cell)) {
+                    OpenClosed(neighbor_cell);
+                    continue;
+                }
+                fill_stack_.push_back(ToIndex(neighbor_cell));
+                while (x < to && IsFillable(Cell{.x = x + 1, .y = row})) {
+                    ++x;
+                }
+            }
+        }
+    }
+}
+
+void Minesweeper::BitboardFill() {
+    // The empty region is grown as a bitmask: each row pass ORs the rows
+    // above and below, dilates by one cell and closes whole horizontal runs
+    // of fillable cells. Passes alternate direction until nothing changes,
+    // then the region plus its one-cell border is opened word by word.
+    const size_t words = closed_.WordsPerRow();
+    if (fill_region_.Width() != width_ || fill_region_.Height() != height_) {
+        fill_region_.Assign(width_, height_);
+    }
+    fill_words_.resize(3 * words);
+    size_t top = height_;
+    size_t bottom = 0;
+    for (const CellIndex index: fill_stack_) {
+        const Cell seed = ToCell(index);
+        fill_region_.Set(seed.x, seed.y);
+        top = std::min(top, seed.y);
+        bottom = std::max(bottom, seed.y);
+    }
+    fill_stack_.clear();
+    if (top > bottom) {
         return;
     }
-    std::queue<Cell> q;
-    q.push(cell);
-    closed_cells_.erase(cell);
-    while (!q.empty()) {
-        Cell cur_cell = q.front();
-        q.pop();
-        size_t mines_near = CalcMinesNear(cur_cell);
-        if (!mines_near) {
-            for (int i = -1; i <= 1; ++i) {
-                for (int j = -1; j <= 1; ++j) {
-                    Cell neighbor_cell{.x = cur_cell.x + i, .y = cur_cell.y + j};
-                    if (IsCorrectBoundary(neighbor_cell) && IsClosed(neighbor_cell) &&
-                        !IsMarked(neighbor_cell)) {
-                        q.push(neighbor_cell);
-                        closed_cells_.erase(neighbor_cell);
+    bool changed = true;
+    for (bool downwards = true; changed; downwards = !downwards) {
+        changed = false;
+        size_t lo = top ? top - 1 : top;
+        size_t hi = bottom + 1 < height_ ? bottom + 1 : bottom;
+        if (downwards) {
+            for (size_t y = lo; y <= hi; ++y) {
+                if (DilateRegionRow(y)) {
+                    changed = true;
+                    top = std::min(top, y);
+                    bottom = std::max(bottom, y);
+                    if (y == hi && hi + 1 < height_) {
+                        ++hi;
                     }
                 }
             }
+        } else {
+            for (size_t y = hi + 1; y-- > lo;) {
+                if (DilateRegionRow(y)) {
+                    changed = true;
+                    top = std::min(top, y);
+                    bottom = std::max(bottom, y);
+                    if (y == lo && lo > 0) {
+                        --lo;
+                    }
+                }
+            }
+        }
+    }
+    Word *vertical = fill_words_.data();
+    Word *dilated = vertical + words;
+    const size_t lo = top ? top - 1 : top;
+    const size_t hi = bottom + 1 < height_ ? bottom + 1 : bottom;
+    for (size_t y = lo; y <= hi; ++y) {
+        std::fill(vertical, vertical + words, 0);
+        for (size_t row = (y ? y - 1 : y); row <= y + 1 && row < height_; ++row) {
+            if (top <= row && row <= bottom) {
+                const Word *region = fill_region_.Row(row);
+                for (size_t w = 0; w < words; ++w) {
+                    vertical[w] |= region[w];
+                }
+            }
+        }
+        DilateRow(vertical, dilated, words);
+        const Word *closed = closed_.Row(y);
+        const Word *marked = marked_.Row(y);
+        for (size_t w = 0; w < words; ++w) {
+            OpenWord(y, w, dilated[w] & closed[w] & ~marked[w]);
         }
     }
-    VictoryCheck();
+    for (size_t y = top; y <= bottom; ++y) {
+        std::fill(fill_region_.Row(y), fill_region_.Row(y) + words, 0);
+    }
+}
+
+bool Minesweeper::DilateRegionRow(size_t y) noexcept {
+    const size_t words = closed_.WordsPerRow();
+    Word *vertical = fill_words_.data();
+    Word *candidate = vertical + words;
+    Word *mask = candidate + words;
+    const Word *above = y ? fill_region_.Row(y - 1) : nullptr;
+    const Word *below = y + 1 < height_ ? fill_region_.Row(y + 1) : nullptr;
+    Word *region = fill_region_.Row(y);
+    const Word *empty = layout_->empty.Row(y);
+    const Word *closed = closed_.Row(y);
+    const Word *marked = marked_.Row(y);
+    for (size_t w = 0; w < words; ++w) {
+        vertical[w] = region[w] | (above ? above[w] : 0) | (below ? below[w] : 0);
+        mask[w] = empty[w] & closed[w] & ~marked[w];
+    }
+    DilateRow(vertical, candidate, words);
+    Word any = 0;
+    for (size_t w = 0; w < words; ++w) {
+        candidate[w] &= mask[w];
+        any |= candidate[w] & ~region[w];
+    }
+    if (!any) {
+        return false;
+    }
+    FillRuns(candidate, mask, words);
+    for (size_t w = 0; w < words; ++w) {
+        region[w] |= candidate[w];
+    }
+    return true;
+}
+
+void Minesweeper::ResetOptions() noexcept {
+    SetCascadeStrategy(CascadeStrategy::SCANLINE);
+    SetClock(nullptr);
+    EnableJournal(false);
+    EnableUndo(false);
+    EnableChangeTracking(true);
+    SetChangeHistoryLimit(kDefaultChangeHistoryLimit);
+    ResetInstrumentation();
+}
+
+void Minesweeper::SetCascadeStrategy(CascadeStrategy strategy) noexcept {
+    cascade_strategy_ = strategy;
+}
+
+Minesweeper::CascadeStrategy Minesweeper::GetCascadeStrategy() const noexcept {
+    return cascade_strategy_;
+}
+
+size_t Minesweeper::GetWidth() const noexcept {
+    return width_;
+}
+
+size_t Minesweeper::GetHeight() const noexcept {
+    return height_;
 }
 
 Minesweeper::GameStatus Minesweeper::GetGameStatus() const noexcept {
     return status_;
 }
 
+uint64_t Minesweeper::GetSeed() const noexcept {
+    return seed_;
+}
+
+uint64_t Minesweeper::GetDealId() const noexcept {
+    return deal_id_;
+}
+
 time_t Minesweeper::GetGameTime() const noexcept {
+    return static_cast<time_t>(std::chrono::duration_cast<std::chrono::seconds>(GetGameDuration()).count());
+}
+
+Minesweeper::Clock::duration Minesweeper::GetGameDuration() const noexcept {
     if (status_ == GameStatus::NOT_STARTED) {
-        return 0;
+        return {};
     }
     if (status_ == GameStatus::IN_PROGRESS) {
-        return std::time(NULL) - start_time_;
+        return Now() - start_time_;
     }
     return finish_time_ - start_time_;
 }
 
-Minesweeper::RenderedField Minesweeper::RenderField() const {
-    RenderedField result(height_);
-    for (size_t y = 0; y < height_; ++y) {
-        result[y].reserve(width_);
-        for (size_t x = 0; x < width_; ++x) {
-            Cell cell{.x = x, .y = y};
-            if (IsMine(cell) && status_ == GameStatus::DEFEAT) {
-                result[y] += "*";
-            } else if (IsMarked(cell)) {
-                result[y] += "?";
-            } else if (IsClosed(cell)) {
-                result[y] += "-";
+Minesweeper::Clock::time_point Minesweeper::SteadyNow() noexcept {
+    return Clock::now();
+}
+
+void Minesweeper::SetClock(ClockSource clock) noexcept {
+    clock_ = clock ? clock : SteadyNow;
+}
+
+char Minesweeper::RenderCell(const Cell &cell) const noexcept {
+    if (IsMine(cell) && status_ == GameStatus::DEFEAT) {
+        return '*';
+    }
+    if (IsMarked(cell)) {
+        return '?';
+    }
+    if (IsClosed(cell)) {
+        return '-';
+    }
+    return kMinesNearSymbols[CalcMinesNear(cell)];
+}
+
+void Minesweeper::RenderRow(size_t y, size_t x_from, size_t x_to, char *out) const noexcept {
+    const Word *mines = layout_->mines.Row(y);
+    const Word *marked = marked_.Row(y);
+    const Word *closed = closed_.Row(y);
+    const uint8_t *near = layout_->mines_near.data() + PaddedIndex(Cell{.x = 0, .y = y});
+    const bool show_mines = status_ == GameStatus::DEFEAT;
+    out -= x_from;
+    for (size_t w = x_from / BitPlane::kWordBits; w * BitPlane::kWordBits < x_to; ++w) {
+        const size_t word_begin = w * BitPlane::kWordBits;
+        const size_t begin = std::max(word_begin, x_from);
+        const size_t end = std::min(word_begin + BitPlane::kWordBits, x_to);
+        const size_t span = end - begin;
+        const Word range = (span < BitPlane::kWordBits ? (Word{1} << span) - 1 : ~Word{0}) << (begin - word_begin);
+        const Word special = (marked[w] | (show_mines ? mines[w] : 0)) & range;
+        if (!special && (closed[w] & range) == range) {
+            std::memset(out + begin, '-', span);
+            continue;
+        }
+        for (size_t x = begin; x < end; ++x) {
+            const Word bit = Word{1} << (x - word_begin);
+            if (show_mines && (mines[w] & bit)) {
+                out[x] = '*';
+            } else if (marked[w] & bit) {
+                out[x] = '?';
+            } else if (closed[w] & bit) {
+                out[x] = '-';
             } else {
-                size_t mines = CalcMinesNear(cell);
-                result[y] += (mines ? (std::to_string(mines)) : ".");
+                out[x] = kMinesNearSymbols[near[x]];
             }
         }
     }
+}
+
+void Minesweeper::CheckRegion(size_t x, size_t y, size_t width, size_t height) const {
+    if (x > width_ || y > height_ || width > width_ - x || height > height_ - y) {
+        throw std::runtime_error("A region outside the field boundary");
+    }
+}
+
+Minesweeper::GameStats Minesweeper::GetGameStats() const noexcept {
+    const size_t safe_count = height_ * width_ - mines_count_;
+    return GameStats{
+            .mines_count = mines_count_,
+            .marked_count = marked_count_,
+            .opened_count = opened_count_,
+            .closed_safe_count = closed_count_ - mines_count_,
+            .mines_left = static_cast<int64_t>(mines_count_) - static_cast<int64_t>(marked_count_),
+            .progress = safe_count ? static_cast<double>(opened_count_) / static_cast<double>(safe_count) : 1.0,
+    };
+}
+
+const Minesweeper::Instrumentation &Minesweeper::GetInstrumentation() const noexcept {
+    return instrumentation_;
+}
+
+void Minesweeper::CountMove(uint64_t cells_opened) noexcept {
+    ++instrumentation_.moves;
+    instrumentation_.cells_opened += cells_opened;
+    instrumentation_.last_move_cells_opened = cells_opened;
+    instrumentation_.peak_move_cells_opened = std::max(instrumentation_.peak_move_cells_opened, cells_opened);
+}
+
+void Minesweeper::ResetInstrumentation() noexcept {
+    instrumentation_ = Instrumentation{};
+}
+
+Minesweeper::RenderedField Minesweeper::RenderField() const {
+    return RenderRegion(0, 0, width_, height_);
+}
+
+void Minesweeper::RenderField(std::span<char> buffer, size_t stride) const {
+    RenderRegion(0, 0, width_, height_, buffer, stride);
+}
+
+Minesweeper::RenderedField Minesweeper::RenderRegion(size_t x, size_t y, size_t width, size_t height) const {
+    CheckRegion(x, y, width, height);
+    MINESWEEPER_STAT(++instrumentation_.render_calls);
+    MINESWEEPER_STAT(instrumentation_.render_bytes += height * width);
+    RenderedField result(height);
+    for (size_t row = 0; row < height; ++row) {
+        result[row].resize(width);
+        RenderRow(y + row, x, x + width, result[row].data());
+    }
     return result;
 }
+
+void Minesweeper::RenderRegion(size_t x, size_t y, size_t width, size_t height, std::span<char> buffer,
+                               size_t stride) const {
+    CheckRegion(x, y, width, height);
+    if (stride < width) {
+        throw std::runtime_error("Row stride is less than the field width");
+    }
+    if (height && buffer.size() < (height - 1) * stride + width) {
+        throw std::runtime_error("Render buffer is too small");
+    }
+    MINESWEEPER_STAT(++instrumentation_.render_calls);
+    MINESWEEPER_STAT(instrumentation_.render_bytes += height * width);
+    for (size_t row = 0; row < height; ++row) {
+        RenderRow(y + row, x, x + width, buffer.data() + row * stride);
+    }
+}
+
+uint64_t Minesweeper::GetRevision() const noexcept {
+    return first_revision_ + revision_offsets_.size() - 1;
+}
+
+uint64_t Minesweeper::GetOldestRevision() const noexcept {
+    return first_revision_;
+}
+
+void Minesweeper::SetChangeHistoryLimit(size_t revisions) noexcept {
+    change_history_limit_ = revisions;
+}
+
+void Minesweeper::EnableChangeTracking(bool enabled) noexcept {
+    first_revision_ = GetRevision();
+    changes_.clear();
+    revision_offsets_.assign(1, 0);
+    track_changes_ = enabled;
+}
+
+Minesweeper::RenderedChanges Minesweeper::RenderChanges(uint64_t since_revision) const {
+    return RenderChanges(since_revision, 0, 0, width_, height_);
+}
+
+Minesweeper::RenderedChanges Minesweeper::RenderChanges(uint64_t since_revision, size_t x, size_t y, size_t width,
+                                                        size_t height) const {
+    const std::vector<CellIndex> indices = CollectChanges(since_revision, x, y, width, height);
+    RenderedChanges result;
+    result.reserve(indices.size());
+    MINESWEEPER_STAT(++instrumentation_.render_calls);
+    MINESWEEPER_STAT(instrumentation_.render_bytes += indices.size() * sizeof(CellUpdate));
+    for (const CellIndex index: indices) {
+        const Cell cell = ToCell(index);
+        result.push_back(CellUpdate{.cell = cell, .symbol = RenderCell(cell)});
+    }
+    return result;
+}
+
+Minesweeper::RenderedIndexChanges Minesweeper::RenderIndexChanges(uint64_t since_revision) const {
+    const std::vector<CellIndex> indices = CollectChanges(since_revision, 0, 0, width_, height_);
+    RenderedIndexChanges result;
+    result.reserve(indices.size());
+    MINESWEEPER_STAT(++instrumentation_.render_calls);
+    MINESWEEPER_STAT(instrumentation_.render_bytes += indices.size() * sizeof(IndexUpdate));
+    for (const CellIndex index: indices) {
+        result.push_back(IndexUpdate{.index = index, .symbol = RenderCell(ToCell(index))});
+    }
+    return result;
+}
+
+std::vector<Minesweeper::CellIndex> Minesweeper::CollectChanges(uint64_t since_revision, size_t x, size_t y,
+                                                                size_t width, size_t height) const {
+    if (since_revision > GetRevision()) {
+        throw std::runtime_error("Unknown revision");
+    }
+    if (since_revision < first_revision_) {
+        throw std::runtime_error("Revision is no longer in the change log");
+    }
+    CheckRegion(x, y, width, height);
+    std::vector<CellIndex> indices;
+    for (size_t i = revision_offsets_[since_revision - first_revision_]; i < changes_.size(); ++i) {
+        const CellIndex index = changes_[i];
+        if (index % width_ - x < width && index / width_ - y < height) {
+            indices.push_back(index);
+        }
+    }
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    return indices;
+}
@@ -1,10 +1,20 @@
 #pragma once
 
-#include <random>
+#include "BitPlane.h"
+#include "Xoshiro256.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <span>
 #include <string>
-#include <unordered_set>
 #include <vector>
 
+class SnapshotView;
+
 class Minesweeper {
 public:
     struct Cell {
@@ -18,6 +28,9 @@ public:
         size_t operator()(const Cell &cell) const noexcept;
     };
 
+    // Row-major linear cell index; boards are limited to 2^32 cells.
+    using CellIndex = uint32_t;
+
     enum class GameStatus {
         NOT_STARTED,
         IN_PROGRESS,
@@ -25,56 +38,357 @@ public:
         DEFEAT,
     };
 
+    enum class MinePlacement {
+        IMMEDIATE,
+        FIRST_CLICK_SAFE,
+    };
+
+    enum class CascadeStrategy {
+        SCANLINE,
+        BITBOARD,
+    };
+
+    enum class MoveType : uint8_t {
+        OPEN,
+        MARK,
+        CHORD,
+    };
+
+    enum class MoveResult : uint8_t {
+        IGNORED,
+        APPLIED,
+        OUT_OF_BOUNDS,
+        DEFEAT,
+        VICTORY,
+    };
+
+    struct Move {
+        MoveType type = MoveType::OPEN;
+        Cell cell;
+    };
+
+    struct CellUpdate {
+        Cell cell;
+        char symbol = '-';
+    };
+
+    // Compact forms of Move and CellUpdate, 8 bytes instead of 24.
+    struct IndexMove {
+        MoveType type = MoveType::OPEN;
+        CellIndex index = 0;
+    };
+
+    struct IndexUpdate {
+        CellIndex index = 0;
+        char symbol = '-';
+    };
+
+    struct GameStats {
+        size_t mines_count = 0;
+        size_t marked_count = 0;
+        size_t opened_count = 0;
+        size_t closed_safe_count = 0;
+        int64_t mines_left = 0;
+        double progress = 0.0;
+    };
+
+    using RandomEngine = Xoshiro256;
+
+    using Clock = std::chrono::steady_clock;
+
+    using ClockSource = Clock::time_point (*)() noexcept;
+
+    struct Instrumentation {
+        uint64_t moves = 0;
+        uint64_t cells_opened = 0;
+        uint64_t last_move_cells_opened = 0;
+        uint64_t peak_move_cells_opened = 0;
+        size_t peak_fill_stack = 0;
+        uint64_t calc_mines_near_calls = 0;
+        uint64_t render_calls = 0;
+        uint64_t render_bytes = 0;
+        Clock::duration field_definition_time{};
+    };
+
     using RenderedField = std::vector<std::string>;
 
+    using RenderedChanges = std::vector<CellUpdate>;
+
+    using RenderedIndexChanges = std::vector<IndexUpdate>;
+
+    static constexpr size_t kDefaultChangeHistoryLimit = 1024;
+
     Minesweeper(size_t width, size_t height, size_t mines_count);
 
+    Minesweeper(size_t width, size_t height, size_t mines_count, uint64_t seed,
+                MinePlacement placement = MinePlacement::IMMEDIATE);
+
     Minesweeper(size_t width, size_t height, const std::vector<Cell> &cells_with_mines);
 
+    explicit Minesweeper(const SnapshotView &snapshot);
+
+    // A copy of the current position that shares the mine layout with this
+    // game instead of copying it, and starts with an empty change log,
+    // journal and undo history. Forks can be played on separate threads.
+    Minesweeper Fork() const;
+
     void NewGame(size_t width, size_t height, size_t mines_count);
 
+    void NewGame(size_t width, size_t height, size_t mines_count, uint64_t seed,
+                 MinePlacement placement = MinePlacement::IMMEDIATE);
+
     void NewGame(size_t width, size_t height, const std::vector<Cell> &cells_with_mines);
 
+    void Restore(const SnapshotView &snapshot);
+
+    size_t GetSnapshotSize() const noexcept;
+
+    void WriteSnapshot(std::span<std::byte> buffer) const;
+
+    std::vector<std::byte> Snapshot() const;
+
     void OpenCell(const Cell &cell);
 
+    // Opened cells cannot be marked; marking one is ignored.
     void MarkCell(const Cell &cell);
 
+    void ChordCell(const Cell &cell);
+
+    void OpenCell(CellIndex index);
+
+    void MarkCell(CellIndex index);
+
+    void ChordCell(CellIndex index);
+
+    char GetCellSymbol(const Cell &cell) const;
+
+    char GetCellSymbol(CellIndex index) const;
+
+    CellIndex ToIndex(const Cell &cell) const noexcept;
+
+    Cell ToCell(CellIndex index) const noexcept;
+
+    std::vector<MoveResult> ApplyMoves(std::span<const Move> moves);
+
+    std::vector<MoveResult> ApplyMoves(std::span<const IndexMove> moves);
+
+    void EnableJournal(bool enabled) noexcept;
+
+    const std::vector<uint8_t> &GetJournal() const noexcept;
+
+    // Keeps the cells every applied move flipped, so Undo and Redo cost
+    // O(cells changed). History is dropped by a new game and by toggling.
+    // A rollback reuses the cells its move logged while they are still kept;
+    // search loops that never render can also disable change tracking.
+    void EnableUndo(bool enabled) noexcept;
+
+    bool CanUndo() const noexcept;
+
+    bool CanRedo() const noexcept;
+
+    bool Undo();
+
+    bool Redo();
+
+    static Minesweeper Replay(size_t width, size_t height, size_t mines_count, uint64_t seed,
+                              MinePlacement placement, std::span<const uint8_t> journal);
+
+    // Restores every per-game option set below to its default. A new option
+    // belongs here too, so pooled games never inherit a previous holder's.
+    void ResetOptions() noexcept;
+
+    void SetCascadeStrategy(CascadeStrategy strategy) noexcept;
+
+    CascadeStrategy GetCascadeStrategy() const noexcept;
+
+    size_t GetWidth() const noexcept;
+
+    size_t GetHeight() const noexcept;
+
     GameStatus GetGameStatus() const noexcept;
 
+    uint64_t GetSeed() const noexcept;
+
+    // Unique across all games in the process. Every NewGame(), Restore() and
+    // Fork() starts a new deal, so revisions of two deals are never confused.
+    uint64_t GetDealId() const noexcept;
+
     time_t GetGameTime() const noexcept;
 
+    Clock::duration GetGameDuration() const noexcept;
+
+    void SetClock(ClockSource clock) noexcept;
+
+    GameStats GetGameStats() const noexcept;
+
+    const Instrumentation &GetInstrumentation() const noexcept;
+
+    void ResetInstrumentation() noexcept;
+
     RenderedField RenderField() const;
 
+    void RenderField(std::span<char> buffer, size_t stride) const;
+
+    RenderedField RenderRegion(size_t x, size_t y, size_t width, size_t height) const;
+
+    void RenderRegion(size_t x, size_t y, size_t width, size_t height, std::span<char> buffer, size_t stride) const;
+
+    uint64_t GetRevision() const noexcept;
+
+    RenderedChanges RenderChanges(uint64_t since_revision) const;
+
+    RenderedChanges RenderChanges(uint64_t since_revision, size_t x, size_t y, size_t width, size_t height) const;
+
+    RenderedIndexChanges RenderIndexChanges(uint64_t since_revision) const;
+
+    // The oldest revision RenderChanges still accepts. The log keeps at least
+    // the last `revisions` revisions, and drops older ones once they add up to
+    // more cells than the board; clients behind that render the full field.
+    // A new game or Restore() starts past every revision of the last board.
+    uint64_t GetOldestRevision() const noexcept;
+
+    void SetChangeHistoryLimit(size_t revisions) noexcept;
+
+    // Without change tracking revisions still advance, but nothing is logged
+    // and RenderChanges accepts the current revision only.
+    void EnableChangeTracking(bool enabled) noexcept;
+
 private:
+    // Everything derived from the mine placement. It is shared by forks and
+    // rebuilt in place only while no fork holds it.
+    struct Layout {
+        BitPlane mines;
+        BitPlane empty;
+        std::vector<uint8_t> mines_near;
+        std::array<ptrdiff_t, 8> neighbor_offsets{};
+    };
+
+    struct UndoRecord {
+        Move move;
+        GameStatus status_before = GameStatus::NOT_STARTED;
+        GameStatus status_after = GameStatus::NOT_STARTED;
+        size_t cells_begin = 0;
+        size_t journal_size = 0;
+        Clock::time_point journal_time{};
+        bool mines_pending = false;
+        RandomEngine::State random_state{};
+        // Every cell of the move is in the change log after this revision.
+        uint64_t logged_since = 0;
+    };
+
     size_t width_{0};
     size_t height_{0};
-    time_t start_time_{0};
-    time_t finish_time_{0};
+    ClockSource clock_{&Minesweeper::SteadyNow};
+    Clock::time_point start_time_{};
+    Clock::time_point finish_time_{};
     GameStatus status_{GameStatus::NOT_STARTED};
-    std::unordered_set<Cell, CellHash> cells_with_mines_;
-    std::unordered_set<Cell, CellHash> marked_cells_;
-    std::unordered_set<Cell, CellHash> closed_cells_;
-
-    std::mt19937 gen_ = std::mt19937(std::random_device()());
-
-    void FieldDefinition(size_t mines_count);
+    CascadeStrategy cascade_strategy_{CascadeStrategy::SCANLINE};
+    size_t mines_count_{0};
+    bool mines_pending_{false};
+    size_t marked_count_{0};
+    size_t closed_count_{0};
+    size_t opened_count_{0};
+    std::shared_ptr<Layout> layout_;
+    std::vector<uint8_t> layout_scratch_;
+    BitPlane marked_;
+    BitPlane closed_;
+    std::vector<CellIndex> fill_stack_;
+    BitPlane fill_region_;
+    std::vector<BitPlane::Word> fill_words_;
+    std::vector<CellIndex> changes_;
+    std::vector<size_t> revision_offsets_{0};
+    uint64_t first_revision_{0};
+    uint64_t deal_id_{0};
+    size_t change_history_limit_{kDefaultChangeHistoryLimit};
+    bool track_changes_{true};
+    bool journal_enabled_{false};
+    bool replaying_{false};
+    Clock::time_point journal_time_{};
+    Clock::time_point replay_time_{};
+    std::vector<uint8_t> journal_;
+    bool undo_enabled_{false};
+    std::vector<UndoRecord> undo_records_;
+    std::vector<CellIndex> undo_cells_;
+    size_t undo_position_{0};
+    mutable Instrumentation instrumentation_;
+
+    uint64_t seed_{0};
+    RandomEngine gen_;
+
+    Minesweeper() = default;
+
+    void FieldDefinition(size_t mines_count, MinePlacement placement);
 
     void FieldDefinition(const std::vector<Cell> &cells_with_mines);
 
+    void CheckFieldSize() const;
+
     void ResetValues() noexcept;
 
     void SetNewBoundary(size_t width, size_t height) noexcept;
 
-    void FillClosed() noexcept;
+    void FillClosed();
+
+    Layout &OwnLayout();
+
+    void FillMines(size_t mines_count, std::span<const size_t> excluded = {});
+
+    void PlacePendingMines(const Cell &first_cell);
 
-    void FillMines(size_t mines_count) noexcept;
+    void FillMinesNear();
 
     void StartGame() noexcept;
 
-    void Defeat() noexcept;
+    void Defeat();
+
+    void TrackMines();
 
     void VictoryCheck() noexcept;
 
+    bool ApplyBoundedMove(const Move &move);
+
+    MoveResult ApplyListedMove(const Move &move);
+
+    void WriteJournalRecord(const Move &move);
+
+    void RecordUndo(UndoRecord record);
+
+    void FlipUndoCells(size_t position);
+
+    bool RelogChanges(uint64_t revision) noexcept;
+
+    void CommitUndoRevision(UndoRecord &record, bool relogged);
+
+    void ClearUndo() noexcept;
+
+    static Clock::time_point SteadyNow() noexcept;
+
+    Clock::time_point Now() const noexcept;
+
+    void CountMove(uint64_t cells_opened) noexcept;
+
+    bool MarkBoundedCell(const Cell &cell);
+
+    bool OpenBoundedCell(const Cell &cell);
+
+    bool ChordBoundedCell(const Cell &cell);
+
+    void Cascade();
+
+    void OpenClosed(const Cell &cell);
+
+    void OpenWord(size_t y, size_t word, BitPlane::Word bits);
+
+    void CommitRevision();
+
+    void CompactChanges();
+
+    void FloodFill();
+
+    void BitboardFill();
+
+    bool DilateRegionRow(size_t y) noexcept;
+
     bool IsCorrectBoundary(const Cell &cell) const noexcept;
 
     bool IsMine(const Cell &cell) const noexcept;
@@ -85,7 +399,20 @@ private:
 
     bool IsOpened(const Cell &cell) const noexcept;
 
+    bool IsFillable(const Cell &cell) const noexcept;
+
     bool IsFinishedGame() const noexcept;
 
     size_t CalcMinesNear(const Cell &cell) const noexcept;
+
+    size_t PaddedIndex(const Cell &cell) const noexcept;
+
+    char RenderCell(const Cell &cell) const noexcept;
+
+    void RenderRow(size_t y, size_t x_from, size_t x_to, char *out) const noexcept;
+
+    void CheckRegion(size_t x, size_t y, size_t width, size_t height) const;
+
+    std::vector<CellIndex> CollectChanges(uint64_t since_revision, size_t x, size_t y, size_t width,
+                                          size_t height) const;
 };
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+// Unbounded multi-producer single-consumer queue (D. Vyukov's intrusive
+// design). Push is wait-free and may be called from any thread; TryPop must
+// only be called from the single consumer thread.
+template <class T>
+class MpscQueue {
+public:
+    MpscQueue() : tail_(new Node), head_(tail_) {
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    ~MpscQueue() {
+        while (tail_) {
+            Node *next = tail_->next.load(std::memory_order_relaxed);
+            delete tail_;
+            tail_ = next;
+        }
+    }
+
+    void Push(T value) {
+        Node *node = new Node;
+        node->value = std::move(value);
+        Node *prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    bool TryPop(T &value) {
+        Node *next = tail_->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        value = std::move(next->value);
+        delete tail_;
+        tail_ = next;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node *> next{nullptr};
+        T value{};
+    };
+
+    Node *tail_;
+    alignas(64) std::atomic<Node *> head_;
+};
@@ -0,0 +1,142 @@
+#include "NoGuessGenerator.h"
+
+#include "Solver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+bool SolveFromFirstClick(Minesweeper &game, Solver &solver, const Minesweeper::Cell &first_click) {
+    game.OpenCell(first_click);
+    solver.Reset();
+    while (game.GetGameStatus() == Minesweeper::GameStatus::IN_PROGRESS) {
+        const std::vector<Minesweeper::Cell> safe_cells = solver.FindSafeCells();
+        if (safe_cells.empty()) {
+            return false;
+        }
+        for (const auto &cell: safe_cells) {
+            game.OpenCell(cell);
+        }
+    }
+    return game.GetGameStatus() == Minesweeper::GameStatus::VICTORY;
+}
+
+}  // namespace
+
+NoGuessGenerator::NoGuessGenerator(size_t threads_count, uint64_t max_attempts)
+    : threads_count_(std::max<size_t>(threads_count, 1)),
+      max_attempts_(max_attempts),
+      seed_state_((uint64_t{std::random_device{}()} << 32) | std::random_device{}()) {
+}
+
+uint64_t NoGuessGenerator::FindSeed(size_t width, size_t height, size_t mines_count, const Cell &first_click) {
+    {
+        std::lock_guard lock(mutex_);
+        auto it = cache_.find(ToKey(width, height, mines_count, first_click));
+        if (it != cache_.end() && !it->second.empty()) {
+            const uint64_t seed = it->second.back();
+            it->second.pop_back();
+            return seed;
+        }
+    }
+    std::vector<uint64_t> seeds = Search(width, height, mines_count, first_click, 1);
+    const uint64_t seed = seeds.back();
+    seeds.pop_back();
+    if (!seeds.empty()) {
+        std::lock_guard lock(mutex_);
+        auto &cached = cache_[ToKey(width, height, mines_count, first_click)];
+        cached.insert(cached.end(), seeds.begin(), seeds.end());
+    }
+    return seed;
+}
+
+void NoGuessGenerator::NewGame(Minesweeper &game, size_t width, size_t height, size_t mines_count,
+                               const Cell &first_click) {
+    const uint64_t seed = FindSeed(width, height, mines_count, first_click);
+    game.NewGame(width, height, mines_count, seed, Minesweeper::MinePlacement::FIRST_CLICK_SAFE);
+    game.OpenCell(first_click);
+}
+
+void NoGuessGenerator::Prefetch(size_t width, size_t height, size_t mines_count, const Cell &first_click,
+                                size_t count) {
+    const size_t cached_count = CachedCount(width, height, mines_count, first_click);
+    if (cached_count >= count) {
+        return;
+    }
+    const std::vector<uint64_t> seeds = Search(width, height, mines_count, first_click, count - cached_count);
+    std::lock_guard lock(mutex_);
+    auto &cached = cache_[ToKey(width, height, mines_count, first_click)];
+    cached.insert(cached.end(), seeds.begin(), seeds.end());
+}
+
+size_t NoGuessGenerator::CachedCount(size_t width, size_t height, size_t mines_count,
+                                     const Cell &first_click) const {
+    std::lock_guard lock(mutex_);
+    auto it = cache_.find(ToKey(width, height, mines_count, first_click));
+    return it == cache_.end() ? 0 : it->second.size();
+}
+
+bool NoGuessGenerator::IsSolvable(size_t width, size_t height, size_t mines_count, uint64_t seed,
+                                  const Cell &first_click) {
+    Minesweeper game(width, height, mines_count, seed, Minesweeper::MinePlacement::FIRST_CLICK_SAFE);
+    Solver solver(game);
+    return SolveFromFirstClick(game, solver, first_click);
+}
+
+std::vector<uint64_t> NoGuessGenerator::Search(size_t width, size_t height, size_t mines_count,
+                                               const Cell &first_click, size_t count) {
+    if (first_click.x >= width || first_click.y >= height) {
+        throw std::runtime_error("A cell outside the field boundary");
+    }
+    if (mines_count >= height * width) {
+        throw std::runtime_error("Too many mines");
+    }
+    uint64_t base_seed;
+    {
+        std::lock_guard lock(mutex_);
+        base_seed = Xoshiro256::SplitMix64(seed_state_);
+    }
+    // Attempts are claimed one at a time from a shared counter, so a worker
+    // stuck on a slow candidate never holds back the others.
+    std::atomic<uint64_t> next_attempt{0};
+    std::atomic<size_t> found_count{0};
+    std::mutex seeds_mutex;
+    std::vector<uint64_t> seeds;
+    const auto work = [&] {
+        Minesweeper game(width, height, mines_count, base_seed, Minesweeper::MinePlacement::FIRST_CLICK_SAFE);
+        Solver solver(game);
+        while (found_count.load(std::memory_order_relaxed) < count) {
+            const uint64_t attempt = next_attempt.fetch_add(1, std::memory_order_relaxed);
+            if (attempt >= max_attempts_) {
+                return;
+            }
+            const uint64_t seed = base_seed + attempt;
+            game.NewGame(width, height, mines_count, seed, Minesweeper::MinePlacement::FIRST_CLICK_SAFE);
+            if (SolveFromFirstClick(game, solver, first_click)) {
+                std::lock_guard lock(seeds_mutex);
+                seeds.push_back(seed);
+                found_count.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    };
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(threads_count_ - 1);
+        for (size_t i = 1; i < threads_count_; ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+    }
+    if (seeds.empty()) {
+        throw std::runtime_error("No solvable board found");
+    }
+    return seeds;
+}
+
+NoGuessGenerator::BoardKey NoGuessGenerator::ToKey(size_t width, size_t height, size_t mines_count,
+                                                   const Cell &first_click) noexcept {
+    return {width, height, mines_count, first_click.x, first_click.y};
+}
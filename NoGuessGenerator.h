@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Minesweeper.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// Deals FIRST_CLICK_SAFE boards that the Solver clears from the given first
+// click without guessing. Candidate seeds are checked by parallel workers;
+// seeds found beyond the one requested are kept for the next request.
+class NoGuessGenerator {
+public:
+    using Cell = Minesweeper::Cell;
+
+    explicit NoGuessGenerator(size_t threads_count = std::thread::hardware_concurrency(),
+                              uint64_t max_attempts = 1'000'000);
+
+    NoGuessGenerator(const NoGuessGenerator &) = delete;
+
+    NoGuessGenerator &operator=(const NoGuessGenerator &) = delete;
+
+    uint64_t FindSeed(size_t width, size_t height, size_t mines_count, const Cell &first_click);
+
+    void NewGame(Minesweeper &game, size_t width, size_t height, size_t mines_count, const Cell &first_click);
+
+    void Prefetch(size_t width, size_t height, size_t mines_count, const Cell &first_click, size_t count);
+
+    size_t CachedCount(size_t width, size_t height, size_t mines_count, const Cell &first_click) const;
+
+    static bool IsSolvable(size_t width, size_t height, size_t mines_count, uint64_t seed, const Cell &first_click);
+
+private:
+    using BoardKey = std::tuple<size_t, size_t, size_t, size_t, size_t>;
+
+    size_t threads_count_;
+    uint64_t max_attempts_;
+    mutable std::mutex mutex_;
+    uint64_t seed_state_;
+    std::map<BoardKey, std::vector<uint64_t>> cache_;
+
+    std::vector<uint64_t> Search(size_t width, size_t height, size_t mines_count, const Cell &first_click,
+                                 size_t count);
+
+    static BoardKey ToKey(size_t width, size_t height, size_t mines_count, const Cell &first_click) noexcept;
+};
@@ -0,0 +1,350 @@
+#include "ProbabilityEstimator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+bool IsNumber(char symbol) noexcept {
+    return symbol == '.' || (symbol >= '1' && symbol <= '8');
+}
+
+void AppendIndex(std::string &signature, size_t index) {
+    signature.append(reinterpret_cast<const char *>(&index), sizeof(index));
+}
+
+std::vector<double> Convolve(const std::vector<double> &first, const std::vector<double> &second) {
+    std::vector<double> result(first.size() + second.size() - 1, 0.0);
+    for (size_t i = 0; i < first.size(); ++i) {
+        if (first[i] == 0.0) {
+            continue;
+        }
+        for (size_t j = 0; j < second.size(); ++j) {
+            result[i + j] += first[i] * second[j];
+        }
+    }
+    return result;
+}
+
+double LogBinomial(size_t n, size_t k) noexcept {
+    return std::lgamma(static_cast<double>(n) + 1) - std::lgamma(static_cast<double>(k) + 1) -
+           std::lgamma(static_cast<double>(n - k) + 1);
+}
+
+// Walks the cells of a component in order, keeping for every number the
+// mines it still needs and the cells it still has to place them on.
+class ConfigurationCounter {
+public:
+    ConfigurationCounter(std::vector<std::vector<size_t>> cell_constraints, std::vector<int> need,
+                         std::vector<int> free)
+        : cell_constraints_(std::move(cell_constraints)),
+          need_(std::move(need)),
+          free_(std::move(free)),
+          assigned_(cell_constraints_.size(), 0),
+          configurations_(cell_constraints_.size() + 1, 0.0),
+          cell_mines_((cell_constraints_.size() + 1) * cell_constraints_.size(), 0.0) {
+    }
+
+    void Run() {
+        Assign(0, 0);
+    }
+
+    std::vector<double> &Configurations() noexcept {
+        return configurations_;
+    }
+
+    std::vector<double> &CellMines() noexcept {
+        return cell_mines_;
+    }
+
+private:
+    std::vector<std::vector<size_t>> cell_constraints_;
+    std::vector<int> need_;
+    std::vector<int> free_;
+    std::vector<uint8_t> assigned_;
+    std::vector<double> configurations_;
+    std::vector<double> cell_mines_;
+
+    void Assign(size_t cell, size_t mines) {
+        const size_t cells_count = cell_constraints_.size();
+        if (cell == cells_count) {
+            configurations_[mines] += 1.0;
+            double *row = cell_mines_.data() + mines * cells_count;
+            for (size_t i = 0; i < cells_count; ++i) {
+                row[i] += assigned_[i];
+            }
+            return;
+        }
+        const auto &constraints = cell_constraints_[cell];
+        for (const size_t constraint: constraints) {
+            --free_[constraint];
+        }
+        if (std::all_of(constraints.begin(), constraints.end(),
+                        [this](size_t constraint) { return need_[constraint] <= free_[constraint]; })) {
+            Assign(cell + 1, mines);
+        }
+        for (const size_t constraint: constraints) {
+            --need_[constraint];
+        }
+        if (std::all_of(constraints.begin(), constraints.end(), [this](size_t constraint) {
+                return need_[constraint] >= 0 && need_[constraint] <= free_[constraint];
+            })) {
+            assigned_[cell] = 1;
+            Assign(cell + 1, mines + 1);
+            assigned_[cell] = 0;
+        }
+        for (const size_t constraint: constraints) {
+            ++need_[constraint];
+            ++free_[constraint];
+        }
+    }
+};
+
+}  // namespace
+
+ProbabilityEstimator::ProbabilityEstimator(const Minesweeper &game, size_t threads_count)
+    : board_(game), threads_count_(std::max<size_t>(threads_count, 1)) {
+    Rebuild();
+}
+
+void ProbabilityEstimator::Reset() {
+    board_.Reset();
+    Rebuild();
+}
+
+void ProbabilityEstimator::Rebuild() {
+    visited_.assign(board_.GetSymbols().size(), 0);
+    cache_.clear();
+}
+
+std::vector<double> ProbabilityEstimator::Estimate() {
+    Update();
+    std::vector<Component> components = FindComponents();
+
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < components.size(); ++i) {
+        if (!cache_.contains(components[i].signature)) {
+            missing.push_back(i);
+        }
+    }
+    std::vector<Configurations> fresh(missing.size());
+    std::atomic<size_t> next_missing{0};
+    const auto work = [&] {
+        for (size_t i = next_missing++; i < missing.size(); i = next_missing++) {
+            fresh[i] = Count(components[missing[i]]);
+        }
+    };
+    {
+        std::vector<std::jthread> workers;
+        const size_t workers_count = std::min(threads_count_, missing.size());
+        for (size_t i = 1; i < workers_count; ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+    }
+    std::vector<const Configurations *> counted(components.size(), nullptr);
+    std::unordered_map<std::string, Configurations> cache;
+    for (size_t i = 0; i < missing.size(); ++i) {
+        counted[missing[i]] = &(cache[components[missing[i]].signature] = std::move(fresh[i]));
+    }
+    for (size_t i = 0; i < components.size(); ++i) {
+        auto it = cache_.find(components[i].signature);
+        if (it != cache_.end()) {
+            counted[i] = &(cache[components[i].signature] = std::move(it->second));
+        }
+    }
+    cache_ = std::move(cache);
+
+    const std::vector<char> &symbols = board_.GetSymbols();
+    size_t closed_count = 0;
+    size_t known_mines = 0;
+    for (const char symbol: symbols) {
+        closed_count += symbol == '-';
+        known_mines += symbol == '*';
+    }
+    size_t frontier_count = 0;
+    for (const auto &component: components) {
+        frontier_count += component.cells.size();
+    }
+    const size_t mines_total = board_.GetGame().GetGameStats().mines_count;
+    const size_t mines_left = mines_total > known_mines ? mines_total - known_mines : 0;
+    const size_t unconstrained = closed_count - frontier_count;
+
+    // prefix[i] combines components [0, i), suffix[i] combines [i, n).
+    const size_t components_count = components.size();
+    std::vector<std::vector<double>> prefix(components_count + 1, std::vector<double>{1.0});
+    std::vector<std::vector<double>> suffix(components_count + 1, std::vector<double>{1.0});
+    for (size_t i = 0; i < components_count; ++i) {
+        prefix[i + 1] = Convolve(prefix[i], counted[i]->configurations);
+    }
+    for (size_t i = components_count; i-- > 0;) {
+        suffix[i] = Convolve(counted[i]->configurations, suffix[i + 1]);
+    }
+    const std::vector<double> &total = prefix[components_count];
+
+    // weights[s] is proportional to the ways of hiding the remaining mines
+    // among unconstrained cells when the frontier holds s of them.
+    std::vector<double> weights(total.size(), 0.0);
+    double max_log = -std::numeric_limits<double>::infinity();
+    for (size_t s = 0; s < total.size(); ++s) {
+        if (s <= mines_left && mines_left - s <= unconstrained) {
+            max_log = std::max(max_log, LogBinomial(unconstrained, mines_left - s));
+        }
+    }
+    for (size_t s = 0; s < total.size(); ++s) {
+        if (s <= mines_left && mines_left - s <= unconstrained) {
+            weights[s] = std::exp(LogBinomial(unconstrained, mines_left - s) - max_log);
+        }
+    }
+    double norm = 0.0;
+    double unconstrained_mines = 0.0;
+    for (size_t s = 0; s < total.size(); ++s) {
+        norm += total[s] * weights[s];
+        if (unconstrained) {
+            unconstrained_mines += total[s] * weights[s] * static_cast<double>(mines_left - std::min(s, mines_left));
+        }
+    }
+    if (!(norm > 0.0)) {
+        throw std::runtime_error("Inconsistent field");
+    }
+
+    std::vector<double> result(symbols.size(), 0.0);
+    const double unconstrained_probability =
+        unconstrained ? unconstrained_mines / norm / static_cast<double>(unconstrained) : 0.0;
+    for (size_t index = 0; index < symbols.size(); ++index) {
+        if (symbols[index] == '*') {
+            result[index] = 1.0;
+        } else if (symbols[index] == '-') {
+            result[index] = unconstrained_probability;
+        }
+    }
+    for (size_t c = 0; c < components_count; ++c) {
+        const std::vector<double> others = Convolve(prefix[c], suffix[c + 1]);
+        const Configurations &configurations = *counted[c];
+        const size_t cells_count = components[c].cells.size();
+        for (const size_t cell: components[c].cells) {
+            result[cell] = 0.0;
+        }
+        for (size_t t = 0; t < configurations.configurations.size(); ++t) {
+            if (configurations.configurations[t] == 0.0) {
+                continue;
+            }
+            double weight = 0.0;
+            for (size_t s = 0; s < others.size() && t + s < weights.size(); ++s) {
+                weight += others[s] * weights[t + s];
+            }
+            const double *row = configurations.cell_mines.data() + t * cells_count;
+            for (size_t i = 0; i < cells_count; ++i) {
+                result[components[c].cells[i]] += row[i] * weight / norm;
+            }
+        }
+    }
+    return result;
+}
+
+size_t ProbabilityEstimator::CachedComponentsCount() const noexcept {
+    return cache_.size();
+}
+
+void ProbabilityEstimator::Update() {
+    if (board_.Update() == VisibleBoard::UpdateResult::RESET) {
+        Rebuild();
+    }
+}
+
+std::vector<ProbabilityEstimator::Component> ProbabilityEstimator::FindComponents() {
+    const std::vector<char> &symbols = board_.GetSymbols();
+    std::fill(visited_.begin(), visited_.end(), 0);
+    std::vector<Component> components;
+    for (size_t start = 0; start < symbols.size(); ++start) {
+        if (symbols[start] != '-' || visited_[start]) {
+            continue;
+        }
+        bool frontier = false;
+        ForEachNeighbor(start, [&](size_t neighbor) { frontier |= IsConstraint(neighbor); });
+        if (!frontier) {
+            continue;
+        }
+        // Cells and numbers alternate in the breadth-first order, which keeps
+        // the order (and so the signature) a function of the component alone.
+        Component component;
+        component.cells.push_back(start);
+        visited_[start] = 1;
+        for (size_t head = 0; head < component.cells.size(); ++head) {
+            ForEachNeighbor(component.cells[head], [&](size_t constraint) {
+                if (!IsConstraint(constraint) || visited_[constraint]) {
+                    return;
+                }
+                visited_[constraint] = 1;
+                component.constraints.push_back(constraint);
+                ForEachNeighbor(constraint, [&](size_t cell) {
+                    if (symbols[cell] == '-' && !visited_[cell]) {
+                        visited_[cell] = 1;
+                        component.cells.push_back(cell);
+                    }
+                });
+            });
+        }
+        for (const size_t cell: component.cells) {
+            AppendIndex(component.signature, cell);
+        }
+        for (const size_t constraint: component.constraints) {
+            AppendIndex(component.signature, constraint);
+            component.signature.push_back(symbols[constraint]);
+        }
+        components.push_back(std::move(component));
+    }
+    return components;
+}
+
+ProbabilityEstimator::Configurations ProbabilityEstimator::Count(const Component &component) const {
+    const std::vector<char> &symbols = board_.GetSymbols();
+    std::unordered_map<size_t, size_t> local;
+    for (size_t i = 0; i < component.cells.size(); ++i) {
+        local[component.cells[i]] = i;
+    }
+    std::vector<std::vector<size_t>> cell_constraints(component.cells.size());
+    std::vector<int> need(component.constraints.size());
+    std::vector<int> free(component.constraints.size(), 0);
+    for (size_t c = 0; c < component.constraints.size(); ++c) {
+        const size_t constraint = component.constraints[c];
+        need[c] = symbols[constraint] == '.' ? 0 : symbols[constraint] - '0';
+        ForEachNeighbor(constraint, [&](size_t cell) {
+            if (symbols[cell] == '*') {
+                --need[c];
+            } else if (symbols[cell] == '-') {
+                cell_constraints[local[cell]].push_back(c);
+                ++free[c];
+            }
+        });
+    }
+    ConfigurationCounter counter(std::move(cell_constraints), std::move(need), std::move(free));
+    counter.Run();
+    return Configurations{
+        .configurations = std::move(counter.Configurations()),
+        .cell_mines = std::move(counter.CellMines()),
+    };
+}
+
+bool ProbabilityEstimator::IsConstraint(size_t index) const noexcept {
+    return IsNumber(board_.GetSymbols()[index]);
+}
+
+template <class Visitor>
+void ProbabilityEstimator::ForEachNeighbor(size_t index, Visitor visitor) const {
+    const size_t width = board_.GetWidth();
+    const size_t height = board_.GetHeight();
+    const size_t x = index % width;
+    const size_t y = index / width;
+    for (size_t ny = (y ? y - 1 : 0); ny <= y + 1 && ny < height; ++ny) {
+        for (size_t nx = (x ? x - 1 : 0); nx <= x + 1 && nx < width; ++nx) {
+            if (ny * width + nx != index) {
+                visitor(ny * width + nx);
+            }
+        }
+    }
+}
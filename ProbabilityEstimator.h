@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Minesweeper.h"
+#include "VisibleBoard.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Exact per-cell mine probabilities for what a player can see. The frontier
+// is split into independent components whose configurations are counted
+// separately and then combined with the cells no number touches. Component
+// results are cached, so a move only recounts the components it changed.
+// The game is followed through a VisibleBoard.
+class ProbabilityEstimator {
+public:
+    using Cell = Minesweeper::Cell;
+
+    explicit ProbabilityEstimator(const Minesweeper &game,
+                                  size_t threads_count = std::thread::hardware_concurrency());
+
+    void Reset();
+
+    std::vector<double> Estimate();
+
+    size_t CachedComponentsCount() const noexcept;
+
+private:
+    struct Component {
+        std::vector<size_t> cells;
+        std::vector<size_t> constraints;
+        std::string signature;
+    };
+
+    // configurations[t] ways to place t mines in the component,
+    // cell_mines[t * cells + i] of them with a mine on cell i.
+    struct Configurations {
+        std::vector<double> configurations;
+        std::vector<double> cell_mines;
+    };
+
+    VisibleBoard board_;
+    size_t threads_count_;
+    std::vector<uint8_t> visited_;
+    std::unordered_map<std::string, Configurations> cache_;
+
+    void Update();
+
+    void Rebuild();
+
+    std::vector<Component> FindComponents();
+
+    Configurations Count(const Component &component) const;
+
+    bool IsConstraint(size_t index) const noexcept;
+
+    template <class Visitor>
+    void ForEachNeighbor(size_t index, Visitor visitor) const;
+};
@@ -0,0 +1,93 @@
+#include "Snapshot.h"
+
+#include <bit>
+#include <stdexcept>
+
+namespace {
+
+// Counts the set bits of a plane, or returns SIZE_MAX if any bit is set past
+// the row width.
+size_t CountPlaneBits(const BitPlane::Word *plane, size_t width, size_t height, size_t words_per_row) noexcept {
+    const BitPlane::Word tail = width % BitPlane::kWordBits
+                                ? ~((BitPlane::Word{1} << (width % BitPlane::kWordBits)) - 1)
+                                : 0;
+    size_t result = 0;
+    for (size_t y = 0; y < height; ++y) {
+        const BitPlane::Word *row = plane + y * words_per_row;
+        if (row[words_per_row - 1] & tail) {
+            return SIZE_MAX;
+        }
+        for (size_t w = 0; w < words_per_row; ++w) {
+            result += static_cast<size_t>(std::popcount(row[w]));
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+SnapshotView::SnapshotView(std::span<const std::byte> data) {
+    if (data.size() < sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Snapshot is truncated");
+    }
+    if (reinterpret_cast<uintptr_t>(data.data()) % alignof(SnapshotHeader)) {
+        throw std::runtime_error("Snapshot is misaligned");
+    }
+    header_ = reinterpret_cast<const SnapshotHeader *>(data.data());
+    planes_ = reinterpret_cast<const BitPlane::Word *>(data.data() + sizeof(SnapshotHeader));
+    if (header_->magic != SnapshotHeader::kMagic || header_->byte_order != SnapshotHeader::kByteOrderMark) {
+        throw std::runtime_error("Not a snapshot");
+    }
+    if (header_->version < 1 || header_->version > SnapshotHeader::kVersion) {
+        throw std::runtime_error("Unsupported snapshot version");
+    }
+    if (header_->words_per_row != (header_->width + BitPlane::kWordBits - 1) / BitPlane::kWordBits ||
+        (header_->height && header_->words_per_row > SIZE_MAX / sizeof(BitPlane::Word) / 3 / header_->height)) {
+        throw std::runtime_error("Incorrect snapshot dimensions");
+    }
+    if (data.size() < Size(header_->width, header_->height)) {
+        throw std::runtime_error("Snapshot is truncated");
+    }
+    const uint64_t cells_count = header_->width * header_->height;
+    if (header_->mines_count > cells_count || header_->closed_count > cells_count ||
+        header_->marked_count > cells_count || header_->closed_count + header_->opened_count != cells_count ||
+        header_->status > 3 || header_->cascade_strategy > 1) {
+        throw std::runtime_error("Corrupted snapshot");
+    }
+    // The counters must agree with the planes; a game with pending mines has
+    // none placed yet.
+    const size_t width = header_->width;
+    const size_t height = header_->height;
+    const size_t words_per_row = header_->words_per_row;
+    if (width &&
+        (CountPlaneBits(Mines(), width, height, words_per_row) != (header_->mines_pending ? 0 : header_->mines_count) ||
+         CountPlaneBits(Closed(), width, height, words_per_row) != header_->closed_count ||
+         CountPlaneBits(Marked(), width, height, words_per_row) != header_->marked_count)) {
+        throw std::runtime_error("Corrupted snapshot");
+    }
+}
+
+const SnapshotHeader &SnapshotView::Header() const noexcept {
+    return *header_;
+}
+
+const BitPlane::Word *SnapshotView::Mines() const noexcept {
+    return planes_;
+}
+
+const BitPlane::Word *SnapshotView::Closed() const noexcept {
+    return planes_ + PlaneWords();
+}
+
+const BitPlane::Word *SnapshotView::Marked() const noexcept {
+    return planes_ + 2 * PlaneWords();
+}
+
+size_t SnapshotView::PlaneWords() const noexcept {
+    return header_->words_per_row * header_->height;
+}
+
+size_t SnapshotView::Size(size_t width, size_t height) noexcept {
+    const size_t words_per_row = (width + BitPlane::kWordBits - 1) / BitPlane::kWordBits;
+    return sizeof(SnapshotHeader) + 3 * words_per_row * height * sizeof(BitPlane::Word);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "BitPlane.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+struct SnapshotHeader {
+    static constexpr uint32_t kMagic = 0x5057534d;
+    static constexpr uint16_t kVersion = 2;
+    static constexpr uint16_t kByteOrderMark = 0x0102;
+
+    uint32_t magic = kMagic;
+    uint16_t version = kVersion;
+    uint16_t byte_order = kByteOrderMark;
+    uint64_t width = 0;
+    uint64_t height = 0;
+    uint64_t words_per_row = 0;
+    uint64_t mines_count = 0;
+    uint64_t marked_count = 0;
+    uint64_t closed_count = 0;
+    uint64_t opened_count = 0;
+    uint64_t seed = 0;
+    int64_t elapsed_time = 0;  // nanoseconds since version 2, seconds before
+    std::array<uint64_t, 4> random_state{};
+    uint8_t status = 0;
+    uint8_t mines_pending = 0;
+    uint8_t cascade_strategy = 0;
+    uint8_t reserved[5]{};
+};
+
+static_assert(sizeof(SnapshotHeader) % alignof(BitPlane::Word) == 0);
+
+// Read-only view over a serialized game: the header followed by the mine,
+// closed and marked planes, each height * words_per_row words. The view
+// points into the caller's buffer (e.g. an mmap'd file) and copies nothing.
+class SnapshotView {
+public:
+    explicit SnapshotView(std::span<const std::byte> data);
+
+    const SnapshotHeader &Header() const noexcept;
+
+    const BitPlane::Word *Mines() const noexcept;
+
+    const BitPlane::Word *Closed() const noexcept;
+
+    const BitPlane::Word *Marked() const noexcept;
+
+    size_t PlaneWords() const noexcept;
+
+    static size_t Size(size_t width, size_t height) noexcept;
+
+private:
+    const SnapshotHeader *header_;
+    const BitPlane::Word *planes_;
+};
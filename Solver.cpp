@@ -0,0 +1,259 @@
+#include "Solver.h"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+struct Area {
+    size_t x_from;
+    size_t y_from;
+    size_t x_to;
+    size_t y_to;
+};
+
+Area AreaAround(size_t x, size_t y, size_t radius, size_t width, size_t height) noexcept {
+    return Area{
+        .x_from = x > radius ? x - radius : 0,
+        .y_from = y > radius ? y - radius : 0,
+        .x_to = std::min(x + radius, width - 1),
+        .y_to = std::min(y + radius, height - 1),
+    };
+}
+
+}  // namespace
+
+Solver::Solver(const Minesweeper &game) : board_(game) {
+    Rebuild();
+}
+
+void Solver::Reset() {
+    board_.Reset();
+    Rebuild();
+}
+
+void Solver::Update() {
+    const VisibleBoard::UpdateResult result = board_.Update();
+    if (result == VisibleBoard::UpdateResult::RESET) {
+        Rebuild();
+        return;
+    }
+    if (result == VisibleBoard::UpdateResult::UNCHANGED) {
+        return;
+    }
+    // Only Undo closes a cell again, and what was deduced from it goes too.
+    const std::vector<size_t> &changed = board_.GetChangedCells();
+    const std::vector<char> &symbols = board_.GetSymbols();
+    if (std::ranges::any_of(changed, [&symbols](size_t index) { return symbols[index] == '-'; })) {
+        Rebuild();
+        return;
+    }
+    for (const size_t index: changed) {
+        ApplySymbol(index, symbols[index]);
+    }
+    Propagate();
+}
+
+std::vector<Solver::Cell> Solver::FindSafeCells() {
+    Update();
+    std::erase_if(safe_cells_, [this](size_t index) { return states_[index] != CellState::SAFE; });
+    std::vector<Cell> result;
+    result.reserve(safe_cells_.size());
+    for (const size_t index: safe_cells_) {
+        result.push_back(ToCell(index));
+    }
+    return result;
+}
+
+std::vector<Solver::Cell> Solver::FindCertainMines() {
+    Update();
+    std::vector<Cell> result;
+    result.reserve(mine_cells_.size());
+    for (const size_t index: mine_cells_) {
+        result.push_back(ToCell(index));
+    }
+    return result;
+}
+
+std::optional<Solver::Cell> Solver::Hint() {
+    Update();
+    for (const size_t index: safe_cells_) {
+        if (states_[index] == CellState::SAFE) {
+            return ToCell(index);
+        }
+    }
+    return std::nullopt;
+}
+
+void Solver::Rebuild() {
+    width_ = board_.GetWidth();
+    height_ = board_.GetHeight();
+    states_.assign(width_ * height_, CellState::UNKNOWN);
+    numbers_.assign(width_ * height_, 0);
+    queued_.assign(width_ * height_, 0);
+    worklist_.clear();
+    safe_cells_.clear();
+    mine_cells_.clear();
+    const std::vector<char> &symbols = board_.GetSymbols();
+    for (size_t index = 0; index < symbols.size(); ++index) {
+        ApplySymbol(index, symbols[index]);
+    }
+    Propagate();
+}
+
+void Solver::ApplySymbol(size_t index, char symbol) {
+    if (symbol == '*') {
+        if (states_[index] != CellState::MINE) {
+            Resolve(index, CellState::MINE);
+        }
+    } else if (symbol == '.' || (symbol >= '1' && symbol <= '8')) {
+        if (states_[index] != CellState::OPENED) {
+            states_[index] = CellState::OPENED;
+            numbers_[index] = symbol == '.' ? 0 : static_cast<uint8_t>(symbol - '0');
+            EnqueueAround(index);
+        }
+    }
+}
+
+void Solver::Propagate() {
+    while (!worklist_.empty()) {
+        const size_t index = worklist_.back();
+        worklist_.pop_back();
+        queued_[index] = 0;
+        Deduce(index);
+    }
+}
+
+void Solver::Deduce(size_t index) {
+    std::array<size_t, 8> unknown;
+    const size_t unknown_count = CollectUnknown(index, unknown.data());
+    if (!unknown_count) {
+        return;
+    }
+    const int mines_left = MinesLeft(index);
+    if (mines_left < 0 || static_cast<size_t>(mines_left) > unknown_count) {
+        return;
+    }
+    if (mines_left == 0 || static_cast<size_t>(mines_left) == unknown_count) {
+        const CellState state = mines_left ? CellState::MINE : CellState::SAFE;
+        for (size_t i = 0; i < unknown_count; ++i) {
+            Resolve(unknown[i], state);
+        }
+        return;
+    }
+    DeduceSubsets(index, std::span<const size_t>(unknown.data(), unknown_count), mines_left);
+}
+
+void Solver::DeduceSubsets(size_t index, std::span<const size_t> unknown, int mines_left) {
+    // Only numbers within two cells can share an unknown neighbour.
+    const Area area = AreaAround(index % width_, index / width_, 2, width_, height_);
+    std::array<size_t, 8> other_unknown;
+    std::array<size_t, 8> difference;
+    for (size_t y = area.y_from; y <= area.y_to; ++y) {
+        for (size_t x = area.x_from; x <= area.x_to; ++x) {
+            const size_t other = y * width_ + x;
+            if (other == index || states_[other] != CellState::OPENED) {
+                continue;
+            }
+            const size_t other_count = CollectUnknown(other, other_unknown.data());
+            const int other_left = MinesLeft(other);
+            if (!other_count || other_left < 0) {
+                continue;
+            }
+            const auto inside = [this](std::span<const size_t> cells, size_t center) {
+                return std::all_of(cells.begin(), cells.end(), [&](size_t cell) { return IsNeighbor(cell, center); });
+            };
+            const std::span<const size_t> others(other_unknown.data(), other_count);
+            size_t small = index;
+            size_t large = other;
+            std::span<const size_t> large_unknown = others;
+            int mines_difference = other_left - mines_left;
+            if (!inside(unknown, other)) {
+                if (!inside(others, index)) {
+                    continue;
+                }
+                small = other;
+                large = index;
+                large_unknown = unknown;
+                mines_difference = -mines_difference;
+            }
+            size_t difference_count = 0;
+            for (const size_t cell: large_unknown) {
+                if (!IsNeighbor(cell, small)) {
+                    difference[difference_count++] = cell;
+                }
+            }
+            if (!difference_count || mines_difference < 0 ||
+                (mines_difference != 0 && static_cast<size_t>(mines_difference) != difference_count)) {
+                continue;
+            }
+            const CellState state = mines_difference ? CellState::MINE : CellState::SAFE;
+            for (size_t i = 0; i < difference_count; ++i) {
+                Resolve(difference[i], state);
+            }
+            // The unknown sets are stale now; look at this number again later.
+            Enqueue(index);
+            Enqueue(large);
+            return;
+        }
+    }
+}
+
+void Solver::Resolve(size_t index, CellState state) {
+    states_[index] = state;
+    (state == CellState::MINE ? mine_cells_ : safe_cells_).push_back(index);
+    EnqueueAround(index);
+}
+
+void Solver::Enqueue(size_t index) {
+    if (states_[index] == CellState::OPENED && !queued_[index]) {
+        queued_[index] = 1;
+        worklist_.push_back(index);
+    }
+}
+
+void Solver::EnqueueAround(size_t index) {
+    const Area area = AreaAround(index % width_, index / width_, 1, width_, height_);
+    for (size_t y = area.y_from; y <= area.y_to; ++y) {
+        for (size_t x = area.x_from; x <= area.x_to; ++x) {
+            Enqueue(y * width_ + x);
+        }
+    }
+}
+
+size_t Solver::CollectUnknown(size_t index, size_t *unknown) const noexcept {
+    const Area area = AreaAround(index % width_, index / width_, 1, width_, height_);
+    size_t count = 0;
+    for (size_t y = area.y_from; y <= area.y_to; ++y) {
+        for (size_t x = area.x_from; x <= area.x_to; ++x) {
+            if (states_[y * width_ + x] == CellState::UNKNOWN) {
+                unknown[count++] = y * width_ + x;
+            }
+        }
+    }
+    return count;
+}
+
+int Solver::MinesLeft(size_t index) const noexcept {
+    const Area area = AreaAround(index % width_, index / width_, 1, width_, height_);
+    int result = numbers_[index];
+    for (size_t y = area.y_from; y <= area.y_to; ++y) {
+        for (size_t x = area.x_from; x <= area.x_to; ++x) {
+            result -= states_[y * width_ + x] == CellState::MINE;
+        }
+    }
+    return result;
+}
+
+bool Solver::IsNeighbor(size_t first, size_t second) const noexcept {
+    const size_t first_x = first % width_;
+    const size_t second_x = second % width_;
+    const size_t first_y = first / width_;
+    const size_t second_y = second / width_;
+    return (first_x > second_x ? first_x - second_x : second_x - first_x) <= 1 &&
+           (first_y > second_y ? first_y - second_y : second_y - first_y) <= 1;
+}
+
+Solver::Cell Solver::ToCell(size_t index) const noexcept {
+    return Cell{.x = index % width_, .y = index / width_};
+}
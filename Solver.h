@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Minesweeper.h"
+#include "VisibleBoard.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Deduces safe cells and certain mines from what a player can see.
+// The solver follows the game through a VisibleBoard, so every query only
+// re-examines the frontier around cells that changed since the last one.
+class Solver {
+public:
+    using Cell = Minesweeper::Cell;
+
+    explicit Solver(const Minesweeper &game);
+
+    void Reset();
+
+    void Update();
+
+    std::vector<Cell> FindSafeCells();
+
+    std::vector<Cell> FindCertainMines();
+
+    std::optional<Cell> Hint();
+
+private:
+    enum class CellState : uint8_t {
+        UNKNOWN,
+        SAFE,
+        MINE,
+        OPENED,
+    };
+
+    VisibleBoard board_;
+    size_t width_{0};
+    size_t height_{0};
+    std::vector<CellState> states_;
+    std::vector<uint8_t> numbers_;
+    std::vector<uint8_t> queued_;
+    std::vector<size_t> worklist_;
+    std::vector<size_t> safe_cells_;
+    std::vector<size_t> mine_cells_;
+
+    void Rebuild();
+
+    void ApplySymbol(size_t index, char symbol);
+
+    void Propagate();
+
+    void Deduce(size_t index);
+
+    void DeduceSubsets(size_t index, std::span<const size_t> unknown, int mines_left);
+
+    void Resolve(size_t index, CellState state);
+
+    void Enqueue(size_t index);
+
+    void EnqueueAround(size_t index);
+
+    size_t CollectUnknown(size_t index, size_t *unknown) const noexcept;
+
+    int MinesLeft(size_t index) const noexcept;
+
+    bool IsNeighbor(size_t first, size_t second) const noexcept;
+
+    Cell ToCell(size_t index) const noexcept;
+};
@@ -0,0 +1,266 @@
+#include "TiledMinesweeper.h"
+
+#include "BoardGenerator.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+TiledMinesweeper::TiledMinesweeper(size_t width, size_t height, size_t mines_per_tile, uint64_t seed)
+    : width_(width),
+      height_(height),
+      tiles_x_((width + kTileSize - 1) / kTileSize),
+      mines_per_tile_(mines_per_tile),
+      seed_(seed) {
+    if (mines_per_tile > kTileSize * kTileSize) {
+        throw std::runtime_error("Too many mines");
+    }
+    const size_t full_x = width / kTileSize;
+    const size_t full_y = height / kTileSize;
+    const size_t rest_x = width % kTileSize;
+    const size_t rest_y = height % kTileSize;
+    mines_count_ = full_x * full_y * TileMinesCount(kTileSize, kTileSize) +
+                   full_y * TileMinesCount(rest_x, kTileSize) + full_x * TileMinesCount(kTileSize, rest_y) +
+                   TileMinesCount(rest_x, rest_y);
+}
+
+void TiledMinesweeper::OpenCell(const Cell &cell) {
+    if (!IsCorrectBoundary(cell)) {
+        throw std::runtime_error("A cell outside the field boundary");
+    }
+    if (IsFinishedGame() || IsMarked(cell) || IsOpened(cell)) {
+        return;
+    }
+    if (status_ == GameStatus::NOT_STARTED) {
+        StartGame();
+    }
+    MaterializeAround(cell);
+    if (IsMine(cell)) {
+        Defeat();
+        return;
+    }
+    OpenClosed(cell);
+    fill_stack_.push_back(cell);
+    while (!fill_stack_.empty()) {
+        const Cell cur_cell = fill_stack_.back();
+        fill_stack_.pop_back();
+        if (CalcMinesNear(cur_cell)) {
+            continue;
+        }
+        const size_t x_to = std::min(cur_cell.x + 1, width_ - 1);
+        const size_t y_to = std::min(cur_cell.y + 1, height_ - 1);
+        for (size_t y = (cur_cell.y ? cur_cell.y - 1 : 0); y <= y_to; ++y) {
+            for (size_t x = (cur_cell.x ? cur_cell.x - 1 : 0); x <= x_to; ++x) {
+                const Cell neighbor_cell{.x = x, .y = y};
+                if (!IsOpened(neighbor_cell) && !IsMarked(neighbor_cell)) {
+                    OpenClosed(neighbor_cell);
+                    fill_stack_.push_back(neighbor_cell);
+                }
+            }
+        }
+    }
+    VictoryCheck();
+}
+
+void TiledMinesweeper::MarkCell(const Cell &cell) {
+    if (!IsCorrectBoundary(cell)) {
+        throw std::runtime_error("A cell outside the field boundary");
+    }
+    if (IsFinishedGame() || IsOpened(cell)) {
+        return;
+    }
+    if (status_ == GameStatus::NOT_STARTED) {
+        StartGame();
+    }
+    GetTile(cell.x, cell.y).marked[cell.y % kTileSize] ^= Row{1} << (cell.x % kTileSize);
+}
+
+size_t TiledMinesweeper::GetWidth() const noexcept {
+    return width_;
+}
+
+size_t TiledMinesweeper::GetHeight() const noexcept {
+    return height_;
+}
+
+size_t TiledMinesweeper::GetMinesCount() const noexcept {
+    return mines_count_;
+}
+
+TiledMinesweeper::GameStatus TiledMinesweeper::GetGameStatus() const noexcept {
+    return status_;
+}
+
+uint64_t TiledMinesweeper::GetSeed() const noexcept {
+    return seed_;
+}
+
+TiledMinesweeper::Clock::duration TiledMinesweeper::GetGameDuration() const noexcept {
+    if (status_ == GameStatus::NOT_STARTED) {
+        return {};
+    }
+    if (status_ == GameStatus::IN_PROGRESS) {
+        return Clock::now() - start_time_;
+    }
+    return finish_time_ - start_time_;
+}
+
+size_t TiledMinesweeper::GetTilesCount() const noexcept {
+    return tiles_.size();
+}
+
+TiledMinesweeper::RenderedField TiledMinesweeper::RenderRegion(size_t x, size_t y, size_t width,
+                                                               size_t height) const {
+    if (x > width_ || y > height_ || width > width_ - x || height > height_ - y) {
+        throw std::runtime_error("A region outside the field boundary");
+    }
+    RenderedField result(height, std::string(width, '-'));
+    if (!width || !height) {
+        return result;
+    }
+    for (size_t tile_y = y / kTileSize; tile_y <= (y + height - 1) / kTileSize; ++tile_y) {
+        for (size_t tile_x = x / kTileSize; tile_x <= (x + width - 1) / kTileSize; ++tile_x) {
+            const Tile *tile = FindTile(tile_x * kTileSize, tile_y * kTileSize);
+            // Untouched tiles render as closed, unless a lost game shows their mines.
+            Tile generated;
+            if (!tile) {
+                if (status_ != GameStatus::DEFEAT) {
+                    continue;
+                }
+                FillTileMines(tile_x, tile_y, generated.mines);
+                tile = &generated;
+            }
+            const size_t y_from = std::max(y, tile_y * kTileSize);
+            const size_t y_to = std::min(y + height, (tile_y + 1) * kTileSize);
+            const size_t x_from = std::max(x, tile_x * kTileSize);
+            const size_t x_to = std::min(x + width, (tile_x + 1) * kTileSize);
+            for (size_t cell_y = y_from; cell_y < y_to; ++cell_y) {
+                const size_t row = cell_y % kTileSize;
+                char *out = result[cell_y - y].data() - x;
+                for (size_t cell_x = x_from; cell_x < x_to; ++cell_x) {
+                    const Row bit = Row{1} << (cell_x % kTileSize);
+                    if ((tile->mines[row] & bit) && status_ == GameStatus::DEFEAT) {
+                        out[cell_x] = '*';
+                    } else if (tile->marked[row] & bit) {
+                        out[cell_x] = '?';
+                    } else if (tile->opened[row] & bit) {
+                        const size_t mines = CalcMinesNear(Cell{.x = cell_x, .y = cell_y});
+                        out[cell_x] = mines ? static_cast<char>('0' + mines) : '.';
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+size_t TiledMinesweeper::TileMinesCount(size_t tile_width, size_t tile_height) const noexcept {
+    return mines_per_tile_ * tile_width * tile_height / (kTileSize * kTileSize);
+}
+
+void TiledMinesweeper::FillTileMines(size_t tile_x, size_t tile_y, std::array<Row, kTileSize> &mines) const {
+    const size_t tile_width = std::min(kTileSize, width_ - tile_x * kTileSize);
+    const size_t tile_height = std::min(kTileSize, height_ - tile_y * kTileSize);
+    uint64_t state = tile_y * tiles_x_ + tile_x;
+    Xoshiro256 gen(seed_ ^ Xoshiro256::SplitMix64(state));
+    BitPlane plane;
+    BoardGenerator::PlaceMines(plane, tile_width, tile_height, TileMinesCount(tile_width, tile_height), gen);
+    for (size_t row = 0; row < tile_height; ++row) {
+        mines[row] = plane.Row(row)[0];
+    }
+}
+
+TiledMinesweeper::Tile &TiledMinesweeper::GetTile(size_t x, size_t y) {
+    const size_t tile_x = x / kTileSize;
+    const size_t tile_y = y / kTileSize;
+    const auto [it, inserted] = tiles_.try_emplace(tile_y * tiles_x_ + tile_x);
+    if (inserted) {
+        FillTileMines(tile_x, tile_y, it->second.mines);
+    }
+    return it->second;
+}
+
+const TiledMinesweeper::Tile *TiledMinesweeper::FindTile(size_t x, size_t y) const noexcept {
+    const auto it = tiles_.find(y / kTileSize * tiles_x_ + x / kTileSize);
+    return it == tiles_.end() ? nullptr : &it->second;
+}
+
+void TiledMinesweeper::MaterializeAround(const Cell &cell) {
+    // Counting mines near a cell on a tile edge reads the neighbouring tiles.
+    const size_t x_to = std::min(cell.x + 1, width_ - 1);
+    const size_t y_to = std::min(cell.y + 1, height_ - 1);
+    for (size_t tile_y = (cell.y ? cell.y - 1 : 0) / kTileSize; tile_y <= y_to / kTileSize; ++tile_y) {
+        for (size_t tile_x = (cell.x ? cell.x - 1 : 0) / kTileSize; tile_x <= x_to / kTileSize; ++tile_x) {
+            GetTile(tile_x * kTileSize, tile_y * kTileSize);
+        }
+    }
+}
+
+void TiledMinesweeper::OpenClosed(const Cell &cell) {
+    MaterializeAround(cell);
+    GetTile(cell.x, cell.y).opened[cell.y % kTileSize] |= Row{1} << (cell.x % kTileSize);
+    ++opened_count_;
+}
+
+void TiledMinesweeper::StartGame() noexcept {
+    status_ = GameStatus::IN_PROGRESS;
+    start_time_ = Clock::now();
+}
+
+void TiledMinesweeper::Defeat() noexcept {
+    status_ = GameStatus::DEFEAT;
+    finish_time_ = Clock::now();
+}
+
+void TiledMinesweeper::VictoryCheck() noexcept {
+    if (status_ != GameStatus::IN_PROGRESS || opened_count_ != width_ * height_ - mines_count_) {
+        return;
+    }
+    status_ = GameStatus::VICTORY;
+    finish_time_ = Clock::now();
+}
+
+bool TiledMinesweeper::IsCorrectBoundary(const Cell &cell) const noexcept {
+    return cell.x < width_ && cell.y < height_;
+}
+
+bool TiledMinesweeper::IsFinishedGame() const noexcept {
+    return (status_ == GameStatus::VICTORY || status_ == GameStatus::DEFEAT);
+}
+
+bool TiledMinesweeper::IsMine(const Cell &cell) const noexcept {
+    const Tile *tile = FindTile(cell.x, cell.y);
+    return tile && ((tile->mines[cell.y % kTileSize] >> (cell.x % kTileSize)) & 1);
+}
+
+bool TiledMinesweeper::IsOpened(const Cell &cell) const noexcept {
+    const Tile *tile = FindTile(cell.x, cell.y);
+    return tile && ((tile->opened[cell.y % kTileSize] >> (cell.x % kTileSize)) & 1);
+}
+
+bool TiledMinesweeper::IsMarked(const Cell &cell) const noexcept {
+    const Tile *tile = FindTile(cell.x, cell.y);
+    return tile && ((tile->marked[cell.y % kTileSize] >> (cell.x % kTileSize)) & 1);
+}
+
+size_t TiledMinesweeper::CalcMinesNear(const Cell &cell) const noexcept {
+    const size_t tile_cell_x = cell.x % kTileSize;
+    const size_t tile_cell_y = cell.y % kTileSize;
+    if (tile_cell_x && tile_cell_x + 1 < kTileSize && tile_cell_y && tile_cell_y + 1 < kTileSize) {
+        const Tile *tile = FindTile(cell.x, cell.y);
+        size_t result = 0;
+        for (size_t row = tile_cell_y - 1; row <= tile_cell_y + 1; ++row) {
+            result += std::popcount((tile->mines[row] >> (tile_cell_x - 1)) & 7);
+        }
+        return result;
+    }
+    size_t result = 0;
+    const size_t x_to = std::min(cell.x + 1, width_ - 1);
+    const size_t y_to = std::min(cell.y + 1, height_ - 1);
+    for (size_t y = (cell.y ? cell.y - 1 : 0); y <= y_to; ++y) {
+        for (size_t x = (cell.x ? cell.x - 1 : 0); x <= x_to; ++x) {
+            result += IsMine(Cell{.x = x, .y = y});
+        }
+    }
+    return result;
+}
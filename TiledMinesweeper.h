@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Minesweeper.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// A board stored as 64x64 tiles that are created on first touch, for boards
+// far too large for dense planes. Each tile deals its own mines from a hash
+// of the seed and the tile position, so untouched tiles need no storage and
+// memory grows with the explored area only. Full tiles hold exactly
+// mines_per_tile mines; tiles cut by the board edge hold a proportional share.
+class TiledMinesweeper {
+public:
+    using Cell = Minesweeper::Cell;
+
+    using GameStatus = Minesweeper::GameStatus;
+
+    using RenderedField = Minesweeper::RenderedField;
+
+    using Clock = Minesweeper::Clock;
+
+    static constexpr size_t kTileSize = 64;
+
+    TiledMinesweeper(size_t width, size_t height, size_t mines_per_tile, uint64_t seed);
+
+    void OpenCell(const Cell &cell);
+
+    void MarkCell(const Cell &cell);
+
+    size_t GetWidth() const noexcept;
+
+    size_t GetHeight() const noexcept;
+
+    size_t GetMinesCount() const noexcept;
+
+    GameStatus GetGameStatus() const noexcept;
+
+    uint64_t GetSeed() const noexcept;
+
+    Clock::duration GetGameDuration() const noexcept;
+
+    size_t GetTilesCount() const noexcept;
+
+    RenderedField RenderRegion(size_t x, size_t y, size_t width, size_t height) const;
+
+private:
+    using Row = uint64_t;
+
+    struct Tile {
+        std::array<Row, kTileSize> mines{};
+        std::array<Row, kTileSize> opened{};
+        std::array<Row, kTileSize> marked{};
+    };
+
+    size_t width_;
+    size_t height_;
+    size_t tiles_x_;
+    size_t mines_per_tile_;
+    size_t mines_count_{0};
+    uint64_t seed_;
+    GameStatus status_{GameStatus::NOT_STARTED};
+    Clock::time_point start_time_{};
+    Clock::time_point finish_time_{};
+    size_t opened_count_{0};
+    std::unordered_map<uint64_t, Tile> tiles_;
+    std::vector<Cell> fill_stack_;
+
+    size_t TileMinesCount(size_t tile_width, size_t tile_height) const noexcept;
+
+    void FillTileMines(size_t tile_x, size_t tile_y, std::array<Row, kTileSize> &mines) const;
+
+    Tile &GetTile(size_t x, size_t y);
+
+    const Tile *FindTile(size_t x, size_t y) const noexcept;
+
+    void MaterializeAround(const Cell &cell);
+
+    void OpenClosed(const Cell &cell);
+
+    void StartGame() noexcept;
+
+    void Defeat() noexcept;
+
+    void VictoryCheck() noexcept;
+
+    bool IsCorrectBoundary(const Cell &cell) const noexcept;
+
+    bool IsFinishedGame() const noexcept;
+
+    bool IsMine(const Cell &cell) const noexcept;
+
+    bool IsOpened(const Cell &cell) const noexcept;
+
+    bool IsMarked(const Cell &cell) const noexcept;
+
+    size_t CalcMinesNear(const Cell &cell) const noexcept;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// LEB128 integers: seven bits per byte, low bits first, with the high bit
+// set on every byte but the last.
+class Varint {
+public:
+    static void Write(std::vector<uint8_t> &out, uint64_t value) {
+        for (; value >= 0x80; value >>= 7) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    // Throws std::runtime_error(error) on a truncated or overlong value.
+    static uint64_t Read(std::span<const uint8_t> in, size_t &offset, const char *error) {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (offset >= in.size()) {
+                break;
+            }
+            const uint8_t byte = in[offset++];
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error(error);
+    }
+};
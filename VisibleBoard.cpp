@@ -0,0 +1,60 @@
+#include "VisibleBoard.h"
+
+VisibleBoard::VisibleBoard(const Minesweeper &game) : game_(&game) {
+    Reset();
+}
+
+void VisibleBoard::Reset() {
+    width_ = game_->GetWidth();
+    height_ = game_->GetHeight();
+    revision_ = game_->GetRevision();
+    symbols_.assign(width_ * height_, '-');
+    changed_cells_.clear();
+    const Minesweeper::RenderedField field = game_->RenderField();
+    for (size_t y = 0; y < height_; ++y) {
+        for (size_t x = 0; x < width_; ++x) {
+            symbols_[y * width_ + x] = field[y][x] == '?' ? '-' : field[y][x];
+        }
+    }
+}
+
+VisibleBoard::UpdateResult VisibleBoard::Update() {
+    changed_cells_.clear();
+    if (game_->GetWidth() != width_ || game_->GetHeight() != height_ || game_->GetRevision() < revision_ ||
+        revision_ < game_->GetOldestRevision()) {
+        Reset();
+        return UpdateResult::RESET;
+    }
+    if (game_->GetRevision() == revision_) {
+        return UpdateResult::UNCHANGED;
+    }
+    for (const auto &update: game_->RenderIndexChanges(revision_)) {
+        const char symbol = update.symbol == '?' ? '-' : update.symbol;
+        if (symbols_[update.index] != symbol) {
+            symbols_[update.index] = symbol;
+            changed_cells_.push_back(update.index);
+        }
+    }
+    revision_ = game_->GetRevision();
+    return changed_cells_.empty() ? UpdateResult::UNCHANGED : UpdateResult::CHANGED;
+}
+
+const Minesweeper &VisibleBoard::GetGame() const noexcept {
+    return *game_;
+}
+
+size_t VisibleBoard::GetWidth() const noexcept {
+    return width_;
+}
+
+size_t VisibleBoard::GetHeight() const noexcept {
+    return height_;
+}
+
+const std::vector<char> &VisibleBoard::GetSymbols() const noexcept {
+    return symbols_;
+}
+
+const std::vector<size_t> &VisibleBoard::GetChangedCells() const noexcept {
+    return changed_cells_;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Minesweeper.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// What a player can see of a game, followed through RenderChanges. Only a
+// closed cell can be marked, so '?' is kept as '-'; undo turns opened cells
+// and revealed mines back into '-' too. The board renders in full again when the
+// game shrinks its revision, changes size or drops the revision it is at
+// from the change log, which also happens on NewGame() and Restore().
+class VisibleBoard {
+public:
+    enum class UpdateResult {
+        UNCHANGED,
+        CHANGED,
+        RESET,
+    };
+
+    explicit VisibleBoard(const Minesweeper &game);
+
+    void Reset();
+
+    // After CHANGED, GetChangedCells() lists the cells whose symbol changed.
+    UpdateResult Update();
+
+    const Minesweeper &GetGame() const noexcept;
+
+    size_t GetWidth() const noexcept;
+
+    size_t GetHeight() const noexcept;
+
+    const std::vector<char> &GetSymbols() const noexcept;
+
+    const std::vector<size_t> &GetChangedCells() const noexcept;
+
+private:
+    const Minesweeper *game_;
+    size_t width_{0};
+    size_t height_{0};
+    uint64_t revision_{0};
+    std::vector<char> symbols_;
+    std::vector<size_t> changed_cells_;
+};
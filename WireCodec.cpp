@@ -0,0 +1,239 @@
+#include "WireCodec.h"
+
+#include "Varint.h"
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Codes 0-11 are single cells; 12 and 13 start a run of '-' or '.', and 14
+// starts a run of the symbol in the next nibble. A run length follows as
+// nibbles of 3 payload bits with the high bit set on all but the last.
+constexpr std::array<char, 12> kSymbols = {'-', '?', '*', '.', '1', '2', '3', '4', '5', '6', '7', '8'};
+
+constexpr uint8_t kClosedRun = 12;
+constexpr uint8_t kEmptyRun = 13;
+constexpr uint8_t kSymbolRun = 14;
+constexpr size_t kMinRun = 3;
+
+constexpr const char *kCorruptedFrame = "Corrupted wire frame";
+
+uint8_t ToCode(char symbol) {
+    for (uint8_t code = 0; code < kSymbols.size(); ++code) {
+        if (kSymbols[code] == symbol) {
+            return code;
+        }
+    }
+    throw std::runtime_error("Unknown cell symbol");
+}
+
+class NibbleWriter {
+public:
+    explicit NibbleWriter(std::vector<uint8_t> &out) : out_(out) {
+    }
+
+    void Write(uint8_t nibble) {
+        if (high_) {
+            out_.back() |= static_cast<uint8_t>(nibble << 4);
+        } else {
+            out_.push_back(nibble);
+        }
+        high_ = !high_;
+    }
+
+    void WriteLength(uint64_t value) {
+        for (; value >= 8; value >>= 3) {
+            Write(static_cast<uint8_t>((value & 7) | 8));
+        }
+        Write(static_cast<uint8_t>(value));
+    }
+
+    void WriteSymbols(const char *symbols, size_t count) {
+        for (size_t i = 0; i < count;) {
+            size_t end = i + 1;
+            while (end < count && symbols[end] == symbols[i]) {
+                ++end;
+            }
+            const uint8_t code = ToCode(symbols[i]);
+            if (end - i < kMinRun) {
+                for (; i < end; ++i) {
+                    Write(code);
+                }
+                continue;
+            }
+            if (symbols[i] == '-') {
+                Write(kClosedRun);
+            } else if (symbols[i] == '.') {
+                Write(kEmptyRun);
+            } else {
+                Write(kSymbolRun);
+                Write(code);
+            }
+            WriteLength(end - i - kMinRun);
+            i = end;
+        }
+    }
+
+private:
+    std::vector<uint8_t> &out_;
+    bool high_{false};
+};
+
+class NibbleReader {
+public:
+    NibbleReader(std::span<const uint8_t> in, size_t offset) : in_(in), offset_(offset) {
+    }
+
+    uint8_t Read() {
+        if (offset_ >= in_.size()) {
+            throw std::runtime_error(kCorruptedFrame);
+        }
+        const uint8_t nibble = high_ ? in_[offset_++] >> 4 : in_[offset_] & 0x0f;
+        high_ = !high_;
+        return nibble;
+    }
+
+    uint64_t ReadLength() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 3) {
+            const uint8_t nibble = Read();
+            value |= static_cast<uint64_t>(nibble & 7) << shift;
+            if (!(nibble & 8)) {
+                return value;
+            }
+        }
+        throw std::runtime_error(kCorruptedFrame);
+    }
+
+    // Calls emit(symbol, count) for every single cell or run until count
+    // cells have been read.
+    template <class Emit>
+    void ReadSymbols(uint64_t count, Emit emit) {
+        while (count) {
+            const uint8_t code = Read();
+            char symbol;
+            uint64_t length = 1;
+            if (code < kSymbols.size()) {
+                symbol = kSymbols[code];
+            } else if (code == kClosedRun || code == kEmptyRun) {
+                symbol = code == kClosedRun ? '-' : '.';
+                length = ReadLength() + kMinRun;
+            } else if (code == kSymbolRun) {
+                const uint8_t run_code = Read();
+                if (run_code >= kSymbols.size()) {
+                    throw std::runtime_error(kCorruptedFrame);
+                }
+                symbol = kSymbols[run_code];
+                length = ReadLength() + kMinRun;
+            } else {
+                throw std::runtime_error(kCorruptedFrame);
+            }
+            if (length > count) {
+                throw std::runtime_error(kCorruptedFrame);
+            }
+            emit(symbol, length);
+            count -= length;
+        }
+    }
+
+private:
+    std::span<const uint8_t> in_;
+    size_t offset_;
+    bool high_{false};
+};
+
+size_t ReadHeader(std::span<const uint8_t> frame, WireCodec::FrameType type) {
+    if (frame.empty() || frame[0] != static_cast<uint8_t>(type)) {
+        throw std::runtime_error("Unexpected wire frame type");
+    }
+    return 1;
+}
+
+}  // namespace
+
+std::vector<uint8_t> WireCodec::EncodeField(const Minesweeper &game) {
+    const size_t width = game.GetWidth();
+    const size_t height = game.GetHeight();
+    std::string cells(width * height, '-');
+    game.RenderField(std::span<char>(cells), width);
+    std::vector<uint8_t> frame{static_cast<uint8_t>(FrameType::FIELD)};
+    Varint::Write(frame, width);
+    Varint::Write(frame, height);
+    Varint::Write(frame, game.GetDealId());
+    Varint::Write(frame, game.GetRevision());
+    NibbleWriter(frame).WriteSymbols(cells.data(), cells.size());
+    return frame;
+}
+
+std::vector<uint8_t> WireCodec::EncodeChanges(const Minesweeper &game, uint64_t since_revision) {
+    const Minesweeper::RenderedIndexChanges changes = game.RenderIndexChanges(since_revision);
+    std::vector<uint8_t> frame{static_cast<uint8_t>(FrameType::CHANGES)};
+    Varint::Write(frame, game.GetDealId());
+    Varint::Write(frame, since_revision);
+    Varint::Write(frame, game.GetRevision());
+    Varint::Write(frame, changes.size());
+    // Changes come sorted by cell index, so positions go out as gaps.
+    size_t next_index = 0;
+    std::string symbols;
+    symbols.reserve(changes.size());
+    for (const auto &update: changes) {
+        Varint::Write(frame, update.index - next_index);
+        next_index = update.index + 1;
+        symbols.push_back(update.symbol);
+    }
+    NibbleWriter(frame).WriteSymbols(symbols.data(), symbols.size());
+    return frame;
+}
+
+WireCodec::Board WireCodec::DecodeField(std::span<const uint8_t> frame) {
+    size_t offset = ReadHeader(frame, FrameType::FIELD);
+    Board board;
+    board.width = Varint::Read(frame, offset, kCorruptedFrame);
+    board.height = Varint::Read(frame, offset, kCorruptedFrame);
+    board.deal_id = Varint::Read(frame, offset, kCorruptedFrame);
+    board.revision = Varint::Read(frame, offset, kCorruptedFrame);
+    if (board.width && board.height > SIZE_MAX / board.width) {
+        throw std::runtime_error(kCorruptedFrame);
+    }
+    board.field.assign(board.height, std::string(board.width, '-'));
+    size_t index = 0;
+    NibbleReader(frame, offset).ReadSymbols(board.width * board.height, [&](char symbol, uint64_t length) {
+        for (; length; --length, ++index) {
+            board.field[index / board.width][index % board.width] = symbol;
+        }
+    });
+    return board;
+}
+
+void WireCodec::ApplyChanges(std::span<const uint8_t> frame, Board &board) {
+    size_t offset = ReadHeader(frame, FrameType::CHANGES);
+    const uint64_t deal_id = Varint::Read(frame, offset, kCorruptedFrame);
+    const uint64_t since_revision = Varint::Read(frame, offset, kCorruptedFrame);
+    const uint64_t revision = Varint::Read(frame, offset, kCorruptedFrame);
+    if (deal_id != board.deal_id || since_revision != board.revision) {
+        throw std::runtime_error("Wire frame does not apply to this board");
+    }
+    const uint64_t count = Varint::Read(frame, offset, kCorruptedFrame);
+    if (count > frame.size() - offset) {
+        throw std::runtime_error(kCorruptedFrame);
+    }
+    std::vector<size_t> indices(count);
+    size_t next_index = 0;
+    for (auto &index: indices) {
+        index = next_index + Varint::Read(frame, offset, kCorruptedFrame);
+        if (index < next_index || index >= board.width * board.height) {
+            throw std::runtime_error(kCorruptedFrame);
+        }
+        next_index = index + 1;
+    }
+    size_t position = 0;
+    NibbleReader(frame, offset).ReadSymbols(count, [&](char symbol, uint64_t length) {
+        for (; length; --length, ++position) {
+            board.field[indices[position] / board.width][indices[position] % board.width] = symbol;
+        }
+    });
+    board.revision = revision;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Minesweeper.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Compact transport encoding of what a player sees. Cells are 4-bit codes
+// packed two per byte, and runs of one symbol collapse into an escape code
+// plus a length. A FIELD frame carries the whole board; a CHANGES frame
+// carries the cells changed since a revision, on top of an earlier frame
+// of the same deal.
+class WireCodec {
+public:
+    enum class FrameType : uint8_t {
+        FIELD,
+        CHANGES,
+    };
+
+    struct Board {
+        size_t width = 0;
+        size_t height = 0;
+        uint64_t deal_id = 0;
+        uint64_t revision = 0;
+        Minesweeper::RenderedField field;
+    };
+
+    static std::vector<uint8_t> EncodeField(const Minesweeper &game);
+
+    static std::vector<uint8_t> EncodeChanges(const Minesweeper &game, uint64_t since_revision);
+
+    static Board DecodeField(std::span<const uint8_t> frame);
+
+    static void ApplyChanges(std::span<const uint8_t> frame, Board &board);
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    using State = std::array<uint64_t, 4>;
+
+    Xoshiro256() noexcept {
+        Seed(0);
+    }
+
+    explicit Xoshiro256(uint64_t seed) noexcept {
+        Seed(seed);
+    }
+
+    static constexpr result_type min() noexcept {
+        return 0;
+    }
+
+    static constexpr result_type max() noexcept {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    static uint64_t SplitMix64(uint64_t &state) noexcept {
+        uint64_t z = (state += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    void Seed(uint64_t seed) noexcept {
+        for (auto &word: state_) {
+            word = SplitMix64(seed);
+        }
+    }
+
+    result_type operator()() noexcept {
+        const uint64_t result = Rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = Rotl(state_[3], 45);
+        return result;
+    }
+
+    // Uniform value in [0, bound). Unlike std::uniform_int_distribution the
+    // sequence is the same on every standard library, so seeds stay portable.
+    uint64_t Below(uint64_t bound) noexcept {
+        const uint64_t threshold = (0 - bound) % bound;
+        for (;;) {
+            const uint64_t value = (*this)();
+            if (value >= threshold) {
+                return value % bound;
+            }
+        }
+    }
+
+    const State &GetState() const noexcept {
+        return state_;
+    }
+
+    void SetState(const State &state) noexcept {
+        state_ = state;
+    }
+
+private:
+    State state_{};
+
+    static uint64_t Rotl(uint64_t value, int shift) noexcept {
+        return (value << shift) | (value >> (64 - shift));
+    }
+};
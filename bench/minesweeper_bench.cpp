@@ -0,0 +1,163 @@
+#include "BoardGenerator.h"
+#include "Minesweeper.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr int64_t kDensityScale = 1000;
+
+size_t MinesCount(const benchmark::State &state) {
+    return static_cast<size_t>(state.range(0) * state.range(1) * state.range(2) / kDensityScale);
+}
+
+void SetCellsProcessed(benchmark::State &state) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0) * state.range(1));
+}
+
+void BoardSizes(benchmark::internal::Benchmark *benchmark) {
+    for (const int64_t size: {9, 100, 1000, 10000}) {
+        benchmark->Args({size, size, 150});
+    }
+    benchmark->Args({30, 16, 206});
+    benchmark->Unit(benchmark::kMicrosecond);
+}
+
+void Densities(benchmark::internal::Benchmark *benchmark) {
+    for (const int64_t density: {10, 150, 500, 900}) {
+        benchmark->Args({1000, 1000, density});
+    }
+    benchmark->Unit(benchmark::kMicrosecond);
+}
+
+void EmptyBoards(benchmark::internal::Benchmark *benchmark) {
+    for (const int64_t size: {9, 100, 1000, 10000}) {
+        benchmark->Args({size, size, 0});
+    }
+    benchmark->Unit(benchmark::kMicrosecond);
+}
+
+void BM_NewGameRandom(benchmark::State &state) {
+    Minesweeper game(1, 1, 0, 0);
+    uint64_t seed = 0;
+    for (auto _: state) {
+        game.NewGame(state.range(0), state.range(1), MinesCount(state), ++seed);
+        benchmark::ClobberMemory();
+    }
+    SetCellsProcessed(state);
+}
+
+void BM_NewGameFromCells(benchmark::State &state) {
+    std::vector<Minesweeper::Cell> cells;
+    Xoshiro256 gen(1);
+    for (size_t i = 0; i < MinesCount(state); ++i) {
+        cells.push_back(Minesweeper::Cell{.x = gen.Below(state.range(0)), .y = gen.Below(state.range(1))});
+    }
+    Minesweeper game(1, 1, 0, 0);
+    for (auto _: state) {
+        game.NewGame(state.range(0), state.range(1), cells);
+        benchmark::ClobberMemory();
+    }
+    SetCellsProcessed(state);
+}
+
+// Mine placement alone, without the per-cell passes NewGame adds.
+void BM_FillMines(benchmark::State &state) {
+    BitPlane mines;
+    Xoshiro256 gen(1);
+    for (auto _: state) {
+        BoardGenerator::PlaceMines(mines, state.range(0), state.range(1), MinesCount(state), gen);
+        benchmark::DoNotOptimize(mines.Row(0));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * MinesCount(state)));
+}
+
+template <Minesweeper::CascadeStrategy Strategy>
+void BM_OpenCellCascade(benchmark::State &state) {
+    Minesweeper game(state.range(0), state.range(1), 0, 0);
+    game.SetCascadeStrategy(Strategy);
+    for (auto _: state) {
+        state.PauseTiming();
+        game.NewGame(state.range(0), state.range(1), 0, 0);
+        state.ResumeTiming();
+        game.OpenCell(Minesweeper::Cell{.x = static_cast<size_t>(state.range(0) / 2),
+                                        .y = static_cast<size_t>(state.range(1) / 2)});
+        benchmark::DoNotOptimize(game.GetGameStatus());
+    }
+    SetCellsProcessed(state);
+}
+
+Minesweeper MidGame(const benchmark::State &state) {
+    Minesweeper game(state.range(0), state.range(1), MinesCount(state), 1,
+                     Minesweeper::MinePlacement::FIRST_CLICK_SAFE);
+    game.OpenCell(Minesweeper::Cell{.x = static_cast<size_t>(state.range(0) / 2),
+                                    .y = static_cast<size_t>(state.range(1) / 2)});
+    return game;
+}
+
+void BM_RenderField(benchmark::State &state) {
+    const Minesweeper game = MidGame(state);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(game.RenderField());
+    }
+    SetCellsProcessed(state);
+}
+
+void BM_RenderFieldBuffer(benchmark::State &state) {
+    const Minesweeper game = MidGame(state);
+    std::vector<char> buffer(state.range(0) * state.range(1));
+    for (auto _: state) {
+        game.RenderField(buffer, state.range(0));
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    SetCellsProcessed(state);
+}
+
+void BM_RenderRegionViewport(benchmark::State &state) {
+    const Minesweeper game = MidGame(state);
+    const size_t width = std::min<size_t>(state.range(0), 120);
+    const size_t height = std::min<size_t>(state.range(1), 40);
+    std::vector<char> buffer(width * height);
+    for (auto _: state) {
+        game.RenderRegion((state.range(0) - width) / 2, (state.range(1) - height) / 2, width, height, buffer, width);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * width * height));
+}
+
+void BM_MarkCellToggle(benchmark::State &state) {
+    Minesweeper game = MidGame(state);
+    const Minesweeper::Cell cell{.x = 0, .y = 0};
+    for (auto _: state) {
+        game.MarkCell(cell);
+        benchmark::DoNotOptimize(game.GetGameStatus());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+void BM_GameStats(benchmark::State &state) {
+    const Minesweeper game = MidGame(state);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(game.GetGameStats());
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_NewGameRandom)->Apply(BoardSizes);
+BENCHMARK(BM_NewGameFromCells)->Apply(BoardSizes);
+BENCHMARK(BM_FillMines)->Apply(Densities);
+BENCHMARK(BM_OpenCellCascade<Minesweeper::CascadeStrategy::SCANLINE>)->Apply(EmptyBoards);
+BENCHMARK(BM_OpenCellCascade<Minesweeper::CascadeStrategy::BITBOARD>)->Apply(EmptyBoards);
+BENCHMARK(BM_RenderField)->Apply(BoardSizes);
+BENCHMARK(BM_RenderFieldBuffer)->Apply(BoardSizes);
+BENCHMARK(BM_RenderRegionViewport)->Apply(BoardSizes);
+BENCHMARK(BM_MarkCellToggle)->Apply(BoardSizes);
+BENCHMARK(BM_GameStats)->Apply(BoardSizes);
+
+BENCHMARK_MAIN();